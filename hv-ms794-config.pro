@@ -36,32 +36,62 @@ VERSION  = 1.0.0
 DEFINES += PRODUCT_NAME=\\\"$$TARGET\\\" \
     PRODUCT_VERSION=\\\"$$VERSION\\\"
 
-SOURCES += src/buttonedit.cpp \
+SOURCES += src/buttonbinding.cpp \
+    src/buttonedit.cpp \
     src/colorbutton.cpp \
+    src/colorswatch.cpp \
+    src/deviceprobe.cpp \
     src/enumedit.cpp \
+    src/lightingeffect.cpp \
+    src/lightingengine.cpp \
+    src/lightpreview.cpp \
+    src/liveapplier.cpp \
+    src/macrocodec.cpp \
+    src/macrodelegate.cpp \
     src/macroedit.cpp \
+    src/macromodel.cpp \
+    src/macrorecorder.cpp \
+    src/macrotracer.cpp \
     src/main.cpp \
     src/mainwindow.cpp \
     src/mousebuttonbox.cpp \
     src/ms794.cpp \
+    src/pagediagnostics.cpp \
     src/pagelight.cpp \
     src/pagemacro.cpp \
     src/profileedit.cpp \
+    src/reportrateanalyzer.cpp \
     src/usbscancodeedit.cpp \
+    src/usbscancodes.cpp \
     src/pagerate.cpp
 
-HEADERS  += src/buttonedit.h \
+HEADERS  += src/buttonbinding.h \
+    src/buttonedit.h \
     src/colorbutton.h \
+    src/colorswatch.h \
+    src/deviceprobe.h \
     src/enumedit.h \
+    src/lightingeffect.h \
+    src/lightingengine.h \
+    src/lightpreview.h \
+    src/liveapplier.h \
+    src/macrocodec.h \
+    src/macrodelegate.h \
     src/macroedit.h \
+    src/macromodel.h \
+    src/macrorecorder.h \
+    src/macrotracer.h \
     src/mainwindow.h \
     src/micewidget.h \
     src/mousebuttonbox.h \
     src/ms794.h \
+    src/pagediagnostics.h \
     src/pagelight.h \
     src/pagemacro.h \
     src/profileedit.h \
+    src/reportrateanalyzer.h \
     src/usbscancodeedit.h \
+    src/usbscancodes.h \
     src/pagerate.h
 
 FORMS    += ui/mainwindow.ui \
@@ -21,12 +21,25 @@
 INCLUDEPATH += $$PWD
 
 HEADERS += \
+    $$PWD/qhiddescriptor.h \
+    $$PWD/qhiddescriptorcache.h \
     $$PWD/qhiddevice.h \
-    $$PWD/qhidmonitor.h
+    $$PWD/qhidflightrecorder.h \
+    $$PWD/qhidmonitor.h \
+    $$PWD/qhidreportreader.h \
+    $$PWD/qhidringbuffer.h \
+    $$PWD/qhidstats.h \
+    $$PWD/qhidtrace.h
 
 SOURCES += \
+    $$PWD/qhiddescriptor.cpp \
+    $$PWD/qhiddescriptorcache.cpp \
     $$PWD/qhiddevice.cpp \
-    $$PWD/qhidmonitor.cpp
+    $$PWD/qhidflightrecorder.cpp \
+    $$PWD/qhidmonitor.cpp \
+    $$PWD/qhidreportreader.cpp \
+    $$PWD/qhidstats.cpp \
+    $$PWD/qhidtrace.cpp
 
 CONFIG += link_pkgconfig
 
@@ -41,6 +54,16 @@ for (mod, OPTIONAL_MODULES) {
 }
 
 contains(DEFINES, WITH_LIBUSB_1_0) {
+  SOURCES += $$PWD/qhidusbcontext.cpp
+  HEADERS += $$PWD/qhidusbcontext.h
+}
+
+# The tests run against the in-memory device, see qhidemulator.h
+contains(DEFINES, WITH_EMULATED_HID) {
+  SOURCES += $$PWD/qhidemulator.cpp $$PWD/qhidmonitor_emulated.cpp
+  HEADERS += $$PWD/qhidemulator.h $$PWD/qhidmonitor_emulated.h
+}
+else:contains(DEFINES, WITH_LIBUSB_1_0) {
   SOURCES += $$PWD/qhidmonitor_libusb.cpp
   HEADERS += $$PWD/qhidmonitor_libusb.h
 }
@@ -56,7 +79,11 @@ else {
   error("Need libudev or libusb-1.0 development package.")
 }
 
-contains(DEFINES, WITH_HIDAPI) || contains(DEFINES, WITH_HIDAPI_LIBUSB) {
+contains(DEFINES, WITH_EMULATED_HID) {
+  SOURCES += $$PWD/qhiddevice_emulated.cpp
+  HEADERS += $$PWD/qhiddevice_emulated.h
+}
+else:contains(DEFINES, WITH_HIDAPI) || contains(DEFINES, WITH_HIDAPI_LIBUSB) {
   SOURCES += $$PWD/qhiddevice_hidapi.cpp
   HEADERS += $$PWD/qhiddevice_hidapi.h
 }
@@ -0,0 +1,359 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "qhiddescriptor.h"
+
+#include <QJsonArray>
+#include <algorithm>
+
+// The longest report the parser accepts, bits. The transfers are 64K at most.
+#define MAX_REPORT_BITS (0xFFFF * 8)
+
+namespace
+{
+enum Tag
+{
+    TagInput = 0x80,
+    TagOutput = 0x90,
+    TagFeature = 0xB0,
+    TagCollection = 0xA0,
+    TagEndCollection = 0xC0,
+    TagUsagePage = 0x04,
+    TagReportSize = 0x74,
+    TagReportId = 0x84,
+    TagReportCount = 0x94,
+    TagPush = 0xA4,
+    TagPop = 0xB4,
+    TagUsage = 0x08,
+    LongItem = 0xFE,
+};
+
+struct GlobalState
+{
+    int usagePage;
+    int reportSize;
+    int reportCount;
+    int reportId;
+};
+
+bool isEmpty(const QHIDDescriptor::Report &item)
+{
+    return item.size[QHIDDescriptor::Input] + item.size[QHIDDescriptor::Output] + item.size[QHIDDescriptor::Feature] == 0;
+}
+
+template <typename T> void addUnique(std::vector<T> &values, T value)
+{
+    if (std::find(values.begin(), values.end(), value) == values.end())
+        values.push_back(value);
+}
+} // namespace
+
+QHIDDescriptor::QHIDDescriptor()
+    : valid(false)
+{
+}
+
+QHIDDescriptor::Report &QHIDDescriptor::report(int id)
+{
+    for (auto &item : reportList)
+    {
+        if (item.id == id)
+            return item;
+    }
+
+    Report item = {id, {0, 0, 0}};
+    reportList.push_back(item);
+    return reportList.back();
+}
+
+bool QHIDDescriptor::parse(const quint8 *desc, size_t size)
+{
+    GlobalState globals = {0, 0, 0, 0};
+    std::vector<GlobalState> stack;
+    int depth = 0;
+
+    valid = false;
+    usagePages.clear();
+    usages.clear();
+    reportList.clear();
+
+    for (size_t i = 0; i < size;)
+    {
+        int key = desc[i];
+
+        if (key == LongItem)
+        {
+            // Data size, long item tag, data. No long items are defined by the specification.
+            if (i + 2 >= size)
+                return false;
+
+            i += 3 + desc[i + 1];
+            continue;
+        }
+
+        size_t dataLen = key & 0x3;
+        if (dataLen == 3)
+            ++dataLen; // 0,1,2,4
+
+        if (i + dataLen >= size)
+        {
+            // Truncated descriptor
+            return false;
+        }
+
+        quint32 value = 0;
+        for (auto offset = dataLen; offset > 0; --offset)
+        {
+            value <<= 8;
+            value |= desc[i + offset];
+        }
+
+        switch (key & 0xFC)
+        {
+        case TagUsagePage:
+            globals.usagePage = int(value);
+            addUnique(usagePages, int(value));
+            break;
+
+        case TagUsage:
+            // The 4 bytes usage has the page in the high word
+            addUnique(usages, int(dataLen == 4 ? value & 0xFFFF : value));
+            if (dataLen == 4)
+                addUnique(usagePages, int(value >> 16));
+            break;
+
+        case TagReportSize:
+            globals.reportSize = int(value);
+            break;
+
+        case TagReportCount:
+            globals.reportCount = int(value);
+            break;
+
+        case TagReportId:
+            // Zero is reserved
+            if (value == 0 || value > 0xFF)
+                return false;
+            globals.reportId = int(value);
+            break;
+
+        case TagPush:
+            stack.push_back(globals);
+            break;
+
+        case TagPop:
+            if (stack.empty())
+                return false;
+            globals = stack.back();
+            stack.pop_back();
+            break;
+
+        case TagInput:
+        case TagOutput:
+        case TagFeature:
+        {
+            auto type = (key & 0xFC) == TagInput ? Input : (key & 0xFC) == TagOutput ? Output : Feature;
+            auto bits = qint64(globals.reportSize) * globals.reportCount;
+            auto &item = report(globals.reportId);
+
+            if (bits > MAX_REPORT_BITS || item.size[type] + bits > MAX_REPORT_BITS)
+                return false;
+
+            item.size[type] += int(bits);
+            break;
+        }
+
+        case TagCollection:
+            ++depth;
+            break;
+
+        case TagEndCollection:
+            if (depth == 0)
+                return false;
+            --depth;
+            break;
+        }
+
+        i += dataLen + 1;
+    }
+
+    reportList.erase(std::remove_if(reportList.begin(), reportList.end(), isEmpty), reportList.end());
+
+    // The reports without an id are not allowed once the ids are used.
+    for (const auto &item : reportList)
+    {
+        if (item.id == 0 && reportList.size() > 1)
+            return false;
+    }
+
+    valid = depth == 0;
+    return valid;
+}
+
+bool QHIDDescriptor::isValid() const
+{
+    return valid;
+}
+
+bool QHIDDescriptor::hasUsage(int usagePage, int usage) const
+{
+    return std::find(usagePages.begin(), usagePages.end(), usagePage) != usagePages.end()
+        && std::find(usages.begin(), usages.end(), usage) != usages.end();
+}
+
+const std::vector<QHIDDescriptor::Report> &QHIDDescriptor::reports() const
+{
+    return reportList;
+}
+
+bool QHIDDescriptor::usesReportIds() const
+{
+    return !reportList.empty() && reportList.front().id != 0;
+}
+
+int QHIDDescriptor::reportSize(ReportType type, int id) const
+{
+    for (const auto &item : reportList)
+    {
+        if (item.id == id && item.size[type] > 0)
+            return (item.size[type] + 7) / 8;
+    }
+
+    return -1;
+}
+
+int QHIDDescriptor::maxReportSize(ReportType type) const
+{
+    int bits = 0;
+    for (const auto &item : reportList)
+        bits = qMax(bits, item.size[type]);
+
+    return (bits + 7) / 8;
+}
+
+QJsonObject QHIDDescriptor::toJson() const
+{
+    QJsonArray pages, ids, table;
+
+    foreach (auto page, usagePages)
+        pages.append(page);
+
+    foreach (auto usage, usages)
+        ids.append(usage);
+
+    for (const auto &item : reportList)
+    {
+        QJsonObject json;
+        json["id"] = item.id;
+        json["input"] = item.size[Input];
+        json["output"] = item.size[Output];
+        json["feature"] = item.size[Feature];
+        table.append(json);
+    }
+
+    QJsonObject json;
+    json["usage_pages"] = pages;
+    json["usages"] = ids;
+    json["reports"] = table;
+    return json;
+}
+
+QHIDDescriptor QHIDDescriptor::fromJson(const QJsonObject &json)
+{
+    QHIDDescriptor ret;
+
+    foreach (auto value, json["usage_pages"].toArray())
+        ret.usagePages.push_back(value.toInt());
+
+    foreach (auto value, json["usages"].toArray())
+        ret.usages.push_back(value.toInt());
+
+    foreach (auto value, json["reports"].toArray())
+    {
+        auto item = value.toObject();
+        Report report = {item["id"].toInt(), {item["input"].toInt(), item["output"].toInt(), item["feature"].toInt()}};
+        ret.reportList.push_back(report);
+    }
+
+    ret.valid = !ret.reportList.empty();
+    return ret;
+}
+
+bool QHIDDescriptor::findUsage(int usagePage, int usage, const quint8 *desc, size_t size)
+{
+    unsigned int i = 0;
+    int dataLen, keySize;
+    bool usageMatch = false, pageMatch = false;
+
+    while (i < size)
+    {
+        int key = desc[i];
+
+        if ((key & 0xf0) == 0xf0)
+        {
+            /* This is a Long Item. The next byte contains the
+               length of the data section (value) for this key.
+               See the HID specification, version 1.11, section
+               6.2.2.3, titled "Long Items." */
+            dataLen = i + 1 < size ? desc[i + 1] : 0;
+            keySize = 3;
+        }
+        else
+        {
+            /* This is a Short Item. The bottom two bits of the
+               key contain the size code for the data section
+               (value) for this key.  Refer to the HID
+               specification, version 1.11, section 6.2.2.2,
+               titled "Short Items." */
+            dataLen = key & 0x3;
+            if (dataLen == 3)
+                ++dataLen; // 0,1,2,4
+            keySize = 1;
+        }
+
+        auto tag = (key & 0xfc);
+        if (tag == 0x04 || tag == 0x08)
+        {
+            if (i + dataLen >= size)
+            {
+                // Truncated report?
+                return false;
+            }
+
+            int value = 0;
+            for (int offset = dataLen; offset > 0; --offset)
+            {
+                value <<= 8;
+                value |= desc[i + offset];
+            }
+
+            if (tag == 0x04 && value == usagePage)
+                pageMatch = true;
+            else if (tag == 0x08 && value == usage)
+                usageMatch = true;
+
+            if (pageMatch && usageMatch)
+                return true;
+        }
+
+        // Skip over this key and it's associated data.
+        i += dataLen + keySize;
+    }
+
+    return false;
+}
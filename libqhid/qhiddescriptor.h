@@ -0,0 +1,75 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QHIDDESCRIPTOR_H
+#define QHIDDESCRIPTOR_H
+
+#include <QJsonObject>
+#include <vector>
+
+// The HID report descriptor, see the HID specification, version 1.11, section 6.2.2.
+class QHIDDescriptor
+{
+public:
+    enum ReportType
+    {
+        Input,
+        Output,
+        Feature,
+        NumReportTypes,
+    };
+
+    struct Report
+    {
+        int id;
+        // bits, the report id byte is not included
+        int size[NumReportTypes];
+    };
+
+    QHIDDescriptor();
+
+    // Builds the report table. Returns false if the descriptor is malformed.
+    bool parse(const quint8 *desc, size_t size);
+    bool isValid() const;
+
+    // Same rules as findUsage().
+    bool hasUsage(int usagePage, int usage) const;
+    const std::vector<Report> &reports() const;
+    bool usesReportIds() const;
+
+    // bytes without the report id, -1 if there is no such report
+    int reportSize(ReportType type, int id) const;
+    // The longest report of that type, bytes without the report id
+    int maxReportSize(ReportType type) const;
+
+    QJsonObject toJson() const;
+    static QHIDDescriptor fromJson(const QJsonObject &json);
+
+    // Returns true if the descriptor has both the usage page and the usage.
+    static bool findUsage(int usagePage, int usage, const quint8 *desc, size_t size);
+
+private:
+    Report &report(int id);
+
+    bool valid;
+    std::vector<int> usagePages;
+    std::vector<int> usages;
+    std::vector<Report> reportList;
+};
+
+#endif // QHIDDESCRIPTOR_H
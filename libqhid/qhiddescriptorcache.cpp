@@ -0,0 +1,134 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "qhiddescriptorcache.h"
+#include "qhiddescriptor.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringList>
+
+static QMutex mutex;
+static QJsonObject entries;
+static bool loaded = false;
+
+static QString keyPrefix(int vendorId, int deviceId)
+{
+    return QString("%1:%2:").arg(vendorId, 4, 16, QChar('0')).arg(deviceId, 4, 16, QChar('0'));
+}
+
+static void load()
+{
+    if (loaded)
+        return;
+
+    loaded = true;
+    QFile file(QHIDDescriptorCache::path());
+    if (file.open(QFile::ReadOnly))
+        entries = QJsonDocument::fromJson(file.readAll()).object();
+}
+
+static void save()
+{
+    QDir().mkpath(QFileInfo(QHIDDescriptorCache::path()).path());
+
+    QSaveFile file(QHIDDescriptorCache::path());
+    if (!file.open(QFile::WriteOnly) || file.write(QJsonDocument(entries).toJson()) < 0 || !file.commit())
+        qWarning() << "Failed to save" << file.fileName() << file.errorString();
+}
+
+// Drops the entries of the interface, returns true if any.
+static bool removeEntries(const QString &prefix)
+{
+    bool removed = false;
+
+    foreach (auto key, entries.keys())
+    {
+        if (key.startsWith(prefix))
+        {
+            entries.remove(key);
+            removed = true;
+        }
+    }
+
+    return removed;
+}
+
+bool QHIDDescriptorCache::find(
+    int vendorId, int deviceId, int usagePage, int usage, int *interfaceNumber, QHIDDescriptor *descriptor)
+{
+    QMutexLocker lock(&mutex);
+    load();
+
+    auto prefix = keyPrefix(vendorId, deviceId);
+    for (auto iter = entries.constBegin(); iter != entries.constEnd(); ++iter)
+    {
+        if (!iter.key().startsWith(prefix))
+            continue;
+
+        auto entry = QHIDDescriptor::fromJson(iter.value().toObject());
+        if (entry.isValid() && entry.hasUsage(usagePage, usage))
+        {
+            // vid:pid:interface:hash
+            *interfaceNumber = iter.key().section(':', 2, 2).toInt();
+            *descriptor = entry;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void QHIDDescriptorCache::store(int vendorId, int deviceId, int interfaceNumber, const QByteArray &rawDescriptor,
+    const QHIDDescriptor &descriptor)
+{
+    QMutexLocker lock(&mutex);
+    load();
+
+    auto prefix = keyPrefix(vendorId, deviceId) + QString::number(interfaceNumber) + ':';
+    auto hash = QCryptographicHash::hash(rawDescriptor, QCryptographicHash::Sha1).toHex();
+
+    if (entries.contains(prefix + hash))
+        return;
+
+    // The firmware was updated, the old descriptor is no longer valid.
+    removeEntries(prefix);
+    entries[prefix + hash] = descriptor.toJson();
+    save();
+}
+
+void QHIDDescriptorCache::remove(int vendorId, int deviceId, int interfaceNumber)
+{
+    QMutexLocker lock(&mutex);
+    load();
+
+    if (removeEntries(keyPrefix(vendorId, deviceId) + QString::number(interfaceNumber) + ':'))
+        save();
+}
+
+QString QHIDDescriptorCache::path()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("hid-descriptors.json");
+}
@@ -0,0 +1,45 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QHIDDESCRIPTORCACHE_H
+#define QHIDDESCRIPTORCACHE_H
+
+#include <QByteArray>
+#include <QString>
+
+class QHIDDescriptor;
+
+// The parsed report descriptors, kept on disk between the runs. The entries are keyed by
+// VID/PID/interface/descriptor hash, so the reconnect does not need to claim the interfaces
+// to fetch the descriptors again.
+class QHIDDescriptorCache
+{
+public:
+    // Looks up the interface having the usage, returns false if none is cached.
+    static bool find(int vendorId, int deviceId, int usagePage, int usage, int *interfaceNumber,
+        QHIDDescriptor *descriptor);
+    // Replaces the entry of that interface, if any.
+    static void store(int vendorId, int deviceId, int interfaceNumber, const QByteArray &rawDescriptor,
+        const QHIDDescriptor &descriptor);
+    // Forgets the interface, i.e. when it can't be opened anymore.
+    static void remove(int vendorId, int deviceId, int interfaceNumber);
+
+    static QString path();
+};
+
+#endif // QHIDDESCRIPTORCACHE_H
@@ -17,14 +17,141 @@
  */
 
 #include "qhiddevice.h"
-#if defined(WITH_HIDAPI) || defined(WITH_HIDAPI_LIBUSB) || defined(WITH_HIDAPI_HIDRAW)
+#include "qhidstats.h"
+#include "qhidtrace.h"
+#if defined(WITH_EMULATED_HID)
+#include "qhiddevice_emulated.h"
+#elif defined(WITH_HIDAPI) || defined(WITH_HIDAPI_LIBUSB) || defined(WITH_HIDAPI_HIDRAW)
 #include "qhiddevice_hidapi.h"
 #elif defined(Q_OS_WIN32)
 #include "qhiddevice_win32.h"
 #endif
 
+#include <QCoreApplication>
+#include <QDateTime>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QThread>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+#include <QRandomGenerator>
+#endif
+
+#include <string.h>
+
+// The write pacing, the device loses the reports that come too fast. The I/O counts,
+// and the last transfer does not wait.
+static void paceUntil(qint64 time)
+{
+    auto start = QHIDTrace::now();
+    if (time <= start)
+        return;
+
+    QThread::usleep(ulong((time - start) / 1000));
+    QHIDTrace::record(QHIDTrace::Sleep, start, -1, int((time - start) / 1000000), 0);
+}
+
+// 0 .. bound - 1. The sequence must differ between the processes and the threads,
+// otherwise the jitter spreads nothing.
+static int randomInt(int bound)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+    return int(QRandomGenerator::global()->bounded(quint32(bound)));
+#else
+    // qrand() keeps the seed per thread
+    static thread_local bool seeded = false;
+    if (!seeded)
+    {
+        qsrand(uint(QDateTime::currentMSecsSinceEpoch()) ^ uint(QCoreApplication::applicationPid())
+            ^ uint(quintptr(QThread::currentThreadId())));
+        seeded = true;
+    }
+
+    return qrand() % bound;
+#endif
+}
+
+// Decides whether to retry a failed operation, and waits before the retry.
+class Retries
+{
+public:
+    Retries(QHIDTrace::Operation operation, const QHIDIoPolicy &policy)
+        : operation(operation)
+        , policy(policy)
+        , attempt(0)
+        , delay(qMax(0, policy.backoff))
+    {
+        timer.start();
+    }
+
+    bool next(bool transient)
+    {
+        if (!transient || attempt >= policy.maxRetries)
+            return false;
+
+        // Jittered to 50..150%, so the retries of the concurrent clients spread out.
+        auto msec = delay / 2 + randomInt(delay + 1);
+        if (timer.elapsed() + msec > policy.budget)
+            return false;
+
+        ++attempt;
+        delay = qMin(delay * 2, qMax(0, policy.maxBackoff));
+        QHIDStats::recordRetry(operation);
+
+        // Not the pacing, so the stats keep the two apart
+        auto start = QHIDTrace::now();
+        QThread::msleep(ulong(msec));
+        QHIDTrace::record(QHIDTrace::Backoff, start, -1, msec, 0);
+        return true;
+    }
+
+private:
+    QHIDTrace::Operation operation;
+    QHIDIoPolicy policy;
+    QElapsedTimer timer;
+    int attempt;
+    int delay;
+};
+
+// Sends a single report from the reused buffer, the id goes in front and the padding after.
+// Returns what the backend does, the id included.
+static int sendReport(QHIDDevicePrivate *d, QByteArray &buffer, char report, const char *data, int payload,
+    int reportSize, Retries &retries)
+{
+    auto size = 1 + (reportSize > 0 ? reportSize : payload);
+
+    // Grows to the longest report once, never shrinks
+    if (buffer.size() < size)
+        buffer.resize(size);
+
+    auto chunk = buffer.data();
+    chunk[0] = report;
+    memcpy(chunk + 1, data, size_t(payload));
+    memset(chunk + 1 + payload, 0, size_t(size - 1 - payload));
+
+    int written;
+    bool transient;
+
+    do
+    {
+        auto start = QHIDTrace::now();
+        written = d->write(chunk, size);
+        transient = written < 0 && d->isTransientError();
+        QHIDTrace::record(QHIDTrace::Write, start, 0xFF & report, size, written);
+    } while (written < 0 && retries.next(transient));
+
+    return written;
+}
+
+QHIDDevice::QHIDDevice(QObject *parent)
+    : QObject(parent)
+    , inputBufferLength(64)
+    , outputBufferLength(64)
+    , writeDelayValue(20)
+    , readTimeoutValue(3000)
+    , nextWriteTime(0)
+    , d_ptr(nullptr)
+{
+}
 
 QHIDDevice::QHIDDevice(int vendorId, int deviceId, int usagePage, int usage, QObject *parent)
     : QObject(parent)
@@ -32,21 +159,25 @@ QHIDDevice::QHIDDevice(int vendorId, int deviceId, int usagePage, int usage, QOb
     , outputBufferLength(64)
     , writeDelayValue(20)
     , readTimeoutValue(3000)
+    , nextWriteTime(0)
     , d_ptr(new QHIDDevicePrivate(this, vendorId, deviceId, usagePage, usage))
 {
 }
 
 QHIDDevice::~QHIDDevice()
 {
-    d_ptr->q_ptr = nullptr;
+    if (d_ptr)
+        d_ptr->q_ptr = nullptr;
     delete d_ptr;
     d_ptr = nullptr;
 }
 
 bool QHIDDevice::open(int vendorId, int deviceId, int usagePage, int usage)
 {
-    d_ptr->q_ptr = nullptr;
+    if (d_ptr)
+        d_ptr->q_ptr = nullptr;
     delete d_ptr;
+    descriptor = QHIDDescriptor();
     d_ptr = new QHIDDevicePrivate(this, vendorId, deviceId, usagePage, usage);
     return d_ptr->isValid();
 }
@@ -54,22 +185,64 @@ bool QHIDDevice::open(int vendorId, int deviceId, int usagePage, int usage)
 bool QHIDDevice::isValid() const
 {
     Q_D(const QHIDDevice);
-    return d->isValid();
+    return d && d->isValid();
 }
 
 int QHIDDevice::sendFeatureReport(const char *report, int length)
+{
+    return sendFeatureReport(report, length, ioPolicyValue);
+}
+
+int QHIDDevice::sendFeatureReport(const char *report, int length, const QHIDIoPolicy &policy)
 {
     Q_D(QHIDDevice);
-    auto ret = d->sendFeatureReport(report, length);
-    if (writeDelayValue > 0)
-        QThread::msleep(ulong(writeDelayValue));
+    if (!d)
+        return -1;
+
+    Retries retries(QHIDTrace::SendFeatureReport, policy);
+    int ret;
+    bool transient;
+
+    paceUntil(nextWriteTime);
+
+    do
+    {
+        auto start = QHIDTrace::now();
+        ret = d->sendFeatureReport(report, length);
+        transient = ret < 0 && d->isTransientError();
+        QHIDTrace::record(QHIDTrace::SendFeatureReport, start, 0xFF & report[0], length, ret);
+    } while (ret < 0 && retries.next(transient));
+
+    nextWriteTime = QHIDTrace::now() + qint64(writeDelayValue) * 1000000;
     return ret;
 }
 
 int QHIDDevice::getFeatureReport(char *report, int length)
+{
+    return getFeatureReport(report, length, ioPolicyValue);
+}
+
+int QHIDDevice::getFeatureReport(char *report, int length, const QHIDIoPolicy &policy)
 {
     Q_D(QHIDDevice);
-    return d->getFeatureReport(report, length);
+    if (!d)
+        return -1;
+
+    Retries retries(QHIDTrace::GetFeatureReport, policy);
+    int ret;
+    bool transient;
+
+    paceUntil(nextWriteTime);
+
+    do
+    {
+        auto start = QHIDTrace::now();
+        ret = d->getFeatureReport(report, length);
+        transient = ret < 0 && d->isTransientError();
+        QHIDTrace::record(QHIDTrace::GetFeatureReport, start, 0xFF & report[0], length, ret);
+    } while (ret < 0 && retries.next(transient));
+
+    return ret;
 }
 
 int QHIDDevice::write(char report, const char *buffer, int length)
@@ -77,25 +250,63 @@ int QHIDDevice::write(char report, const char *buffer, int length)
     Q_D(QHIDDevice);
     int offset = 0;
 
+    if (!d)
+        return -1;
+
+    // The device expects the output reports of the exact size, if the descriptor is known.
+    auto reportSize = descriptor.reportSize(QHIDDescriptor::Output, 0xFF & report);
+    auto chunkSize = reportSize > 0 ? reportSize : outputBufferLength;
+    // One budget for all the chunks
+    Retries retries(QHIDTrace::Write, ioPolicyValue);
+
     while (length > 0)
     {
-        QByteArray chunk;
-        chunk.reserve(outputBufferLength);
-        chunk.append(report).append(buffer + offset, qMin(length, outputBufferLength));
-        auto written = d->write(chunk.cbegin(), chunk.size());
+        auto payload = qMin(length, chunkSize);
+
+        paceUntil(nextWriteTime);
+        auto written = sendReport(d, outputReport, report, buffer + offset, payload, reportSize, retries);
+        nextWriteTime = QHIDTrace::now() + qint64(writeDelayValue) * 1000000;
 
         if (written <= 0)
             return written;
 
-        if (writeDelayValue > 0)
-            QThread::msleep(ulong(writeDelayValue));
-        offset += written - 1;
-        length -= written - 1;
+        written = qMin(written - 1, payload);
+        offset += written;
+        length -= written;
     }
 
     return offset;
 }
 
+int QHIDDevice::writeReports(const QHIDOutputReport *reports, int count)
+{
+    Q_D(QHIDDevice);
+    int sent = 0;
+
+    if (!d)
+        return -1;
+
+    Retries retries(QHIDTrace::Write, ioPolicyValue);
+    paceUntil(nextWriteTime);
+
+    for (; sent < count; ++sent)
+    {
+        const auto &item = reports[sent];
+        auto reportSize = descriptor.reportSize(QHIDDescriptor::Output, 0xFF & item.report);
+        if (item.length < 0 || item.length > (reportSize > 0 ? reportSize : outputBufferLength))
+        {
+            qWarning() << "writeReports: report" << sent << "is too long:" << item.length;
+            break;
+        }
+
+        if (sendReport(d, outputReport, item.report, item.data, item.length, reportSize, retries) <= 0)
+            break;
+    }
+
+    nextWriteTime = QHIDTrace::now() + qint64(writeDelayValue) * 1000000;
+    return sent > 0 || count <= 0 ? sent : -1;
+}
+
 int QHIDDevice::read(char *buffer, int length)
 {
     return read(buffer, length, readTimeoutValue);
@@ -106,13 +317,27 @@ int QHIDDevice::read(char *buffer, int length, int readTimeout)
     Q_D(QHIDDevice);
     int offset = 0;
 
+    if (!d)
+        return -1;
+
+    QElapsedTimer timer;
+    timer.start();
+
     while (length > 0)
     {
-        auto read = d->read(buffer + offset, length, readTimeout);
+        // A negative timeout blocks, as the backends do.
+        auto timeout = readTimeout < 0 ? readTimeout : qMax(0, readTimeout - int(timer.elapsed()));
+        auto start = QHIDTrace::now();
+        auto read = d->read(buffer + offset, length, timeout);
+        QHIDTrace::record(QHIDTrace::Read, start, -1, length, read);
 
-        if (read <= 0)
+        if (read < 0)
             return read;
 
+        // Out of time, keep what has been read so far
+        if (read == 0)
+            return offset;
+
         offset += read;
         length -= read;
     }
@@ -120,6 +345,19 @@ int QHIDDevice::read(char *buffer, int length, int readTimeout)
     return offset;
 }
 
+int QHIDDevice::readReport(char *buffer, int length, int timeout)
+{
+    Q_D(QHIDDevice);
+    if (!d)
+        return -1;
+
+    // Exactly one report, zero on timeout.
+    auto start = QHIDTrace::now();
+    auto ret = d->read(buffer, length, timeout);
+    QHIDTrace::record(QHIDTrace::Read, start, -1, length, ret);
+    return ret;
+}
+
 int QHIDDevice::readTimeout() const
 {
     return readTimeoutValue;
@@ -139,3 +377,18 @@ void QHIDDevice::setWriteDelay(int value)
 {
     writeDelayValue = value;
 }
+
+QHIDIoPolicy QHIDDevice::ioPolicy() const
+{
+    return ioPolicyValue;
+}
+
+void QHIDDevice::setIoPolicy(const QHIDIoPolicy &value)
+{
+    ioPolicyValue = value;
+}
+
+const QHIDDescriptor &QHIDDevice::reportDescriptor() const
+{
+    return descriptor;
+}
@@ -19,8 +19,41 @@
 #ifndef QHIDDEVICE_H
 #define QHIDDEVICE_H
 
+#include "qhiddescriptor.h"
+
 #include <QObject>
 
+// The retry policy of a single operation. The transient errors (a stalled endpoint, a busy
+// device) are retried with a jittered exponential backoff, a removed device fails at once.
+// No retry starts after the budget is spent, the call in flight is never interrupted.
+// The hidapi-libusb backend does not report the error, so it is retried only when built with
+// libusb-1.0 (the device is looked for on the bus then).
+struct QHIDIoPolicy
+{
+    constexpr QHIDIoPolicy(int budget = 1000, int maxRetries = 3, int backoff = 10, int maxBackoff = 100)
+        : budget(budget)
+        , maxRetries(maxRetries)
+        , backoff(backoff)
+        , maxBackoff(maxBackoff)
+    {
+    }
+
+    // The whole operation with the retries, msec
+    int budget;
+    int maxRetries;
+    // Before the first retry, msec, doubled on each next one
+    int backoff;
+    int maxBackoff;
+};
+
+// One output report of a batch, the data goes without the report id.
+struct QHIDOutputReport
+{
+    char report;
+    const char *data;
+    int length;
+};
+
 class QHIDDevicePrivate;
 class QHIDDevice : public QObject
 {
@@ -31,6 +64,8 @@ class QHIDDevice : public QObject
     Q_DECLARE_PRIVATE(QHIDDevice)
 
 public:
+    // Not opened yet, call open() later.
+    explicit QHIDDevice(QObject *parent = 0);
     QHIDDevice(int vendorId, int deviceId, int usagePage, int usage, QObject *parent = 0);
     ~QHIDDevice();
 
@@ -38,11 +73,21 @@ public:
     bool isValid() const;
 
     int sendFeatureReport(const char *report, int length);
+    int sendFeatureReport(const char *report, int length, const QHIDIoPolicy &policy);
     int getFeatureReport(char *report, int length);
+    int getFeatureReport(char *report, int length, const QHIDIoPolicy &policy);
 
     int write(char report, const char *buffer, int length);
+    // Sends the reports back to back, the write delay is kept once, before the next transfer.
+    // Each one must fit in a single report, the batch stops at a longer one.
+    // Returns the number of the reports sent, -1 if none.
+    int writeReports(const QHIDOutputReport *reports, int count);
     int read(char *buffer, int length);
+    // Fills the whole buffer, the timeout is for all of it, not for each report.
+    // Returns the bytes read by then, 0 if none.
+    // For a stream of the input reports see QHIDReportReader.
     int read(char *buffer, int length, int timeout);
+    int readReport(char *buffer, int length, int timeout);
 
     int readTimeout() const;
     void setReadTimeout(int value);
@@ -50,11 +95,24 @@ public:
     int writeDelay() const;
     void setWriteDelay(int value);
 
+    // For the feature reports & the writes without an explicit policy
+    QHIDIoPolicy ioPolicy() const;
+    void setIoPolicy(const QHIDIoPolicy &value);
+
+    // The report table, if the backend got the descriptor
+    const QHIDDescriptor &reportDescriptor() const;
+
 protected:
     int inputBufferLength;
     int outputBufferLength;
     int writeDelayValue;
     int readTimeoutValue;
+    QHIDIoPolicy ioPolicyValue;
+    // The output report with the id in front, reused by every write
+    QByteArray outputReport;
+    // QHIDTrace::now() of the earliest next transfer, for the write pacing
+    qint64 nextWriteTime;
+    QHIDDescriptor descriptor;
     class QHIDDevicePrivate *d_ptr;
 };
 
@@ -0,0 +1,97 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "qhiddevice.h"
+#include "qhiddevice_emulated.h"
+#include "qhidemulator.h"
+
+#include <errno.h>
+#include <string.h>
+
+// A stall while plugged in, the device is gone otherwise.
+static int fail()
+{
+    errno = QHIDEmulator::silentErrors() ? 0 : QHIDEmulator::isConnected() ? EPIPE : ENODEV;
+    return -1;
+}
+
+QHIDDevicePrivate::QHIDDevicePrivate(QHIDDevice *q_ptr, int, int, int, int)
+    : valid(QHIDEmulator::isConnected())
+    , q_ptr(q_ptr)
+{
+    if (valid)
+        QHIDEmulator::opened(1);
+}
+
+QHIDDevicePrivate::~QHIDDevicePrivate()
+{
+    if (valid)
+        QHIDEmulator::opened(-1);
+}
+
+bool QHIDDevicePrivate::isValid() const
+{
+    return valid;
+}
+
+int QHIDDevicePrivate::sendFeatureReport(const char *buffer, int length)
+{
+    if (!valid || length <= 0 || !QHIDEmulator::transaction())
+        return fail();
+
+    QHIDEmulator::setFeatureReport(QByteArray(buffer, length));
+    return length;
+}
+
+int QHIDDevicePrivate::getFeatureReport(char *buffer, int length)
+{
+    if (!valid || length <= 0 || !QHIDEmulator::transaction())
+        return fail();
+
+    // Unknown reports are read back as zeroes, the id is kept.
+    auto report = QHIDEmulator::featureReport(0xFF & buffer[0]);
+    if (report.isEmpty())
+    {
+        memset(buffer + 1, 0, size_t(length - 1));
+        return length;
+    }
+
+    length = qMin(length, report.size());
+    memcpy(buffer, report.cbegin(), size_t(length));
+    return length;
+}
+
+int QHIDDevicePrivate::write(const char *, int length)
+{
+    if (!valid || !QHIDEmulator::transaction())
+        return fail();
+
+    return length;
+}
+
+int QHIDDevicePrivate::read(char *buffer, int length, int timeout)
+{
+    auto ret = valid ? QHIDEmulator::takeInputReport(buffer, length, timeout) : -1;
+    return ret < 0 ? fail() : ret;
+}
+
+bool QHIDDevicePrivate::isTransientError() const
+{
+    // Without errno, look for the device on the "bus" like the hidapi-libusb backend does.
+    return valid && (errno == EPIPE || (errno == 0 && QHIDEmulator::isConnected()));
+}
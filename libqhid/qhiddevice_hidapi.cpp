@@ -16,6 +16,8 @@
  *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include "qhiddescriptor.h"
+#include "qhiddescriptorcache.h"
 #include "qhiddevice.h"
 #include "qhiddevice_hidapi.h"
 
@@ -24,97 +26,21 @@
 #include <errno.h>
 
 #ifdef WITH_LIBUSB_1_0
-#include <libusb.h>
+#include "qhidusbcontext.h"
 
-static bool findUsage(int usagePage, int usage, const uint8_t *desc, size_t size)
+// Returns true if the interface & the descriptor were taken from the cache.
+static bool hidapiMissingFeatures(int vendorId, int deviceId, int usagePage, int usage, int *interfaceNumber,
+    int *inBufferLength, int *outBufferLength, QHIDDescriptor *descriptor, bool useCache)
 {
-    unsigned int i = 0;
-    int dataLen, keySize;
-    bool usageMatch = false, pageMatch = false;
+    // The descriptors do not change, so there is no need to claim the interfaces again.
+    if (useCache && QHIDDescriptorCache::find(vendorId, deviceId, usagePage, usage, interfaceNumber, descriptor))
+        return true;
 
-    while (i < size)
-    {
-        int key = desc[i];
-
-        if ((key & 0xf0) == 0xf0)
-        {
-            /* This is a Long Item. The next byte contains the
-               length of the data section (value) for this key.
-               See the HID specification, version 1.11, section
-               6.2.2.3, titled "Long Items." */
-            dataLen = i + 1 < size ? desc[i + 1] : 0;
-            keySize = 3;
-        }
-        else
-        {
-            /* This is a Short Item. The bottom two bits of the
-               key contain the size code for the data section
-               (value) for this key.  Refer to the HID
-               specification, version 1.11, section 6.2.2.2,
-               titled "Short Items." */
-            dataLen = key & 0x3;
-            if (dataLen == 3)
-                ++dataLen; // 0,1,2,4
-            keySize = 1;
-        }
-
-        auto tag = (key & 0xfc);
-        if (tag == 0x04 || tag == 0x08)
-        {
-            if (i + dataLen >= size)
-            {
-                // Truncated report?
-                return false;
-            }
-
-            int value = 0;
-            for (int offset = dataLen; offset > 0; --offset)
-            {
-                value <<= 8;
-                value |= desc[i + offset];
-            }
-
-            if (tag == 0x04 && value == usagePage)
-                pageMatch = true;
-            else if (tag == 0x08 && value == usage)
-                usageMatch = true;
-
-            if (pageMatch && usageMatch)
-                return true;
-        }
-
-        // Skip over this key and it's associated data.
-        i += dataLen + keySize;
-    }
-
-    return false;
-}
-
-static void hidapiMissingFeatures(
-    int vendorId, int deviceId, int usagePage, int usage, int *interfaceNumber, int *inBufferLength, int *outBufferLength)
-{
-    libusb_context *ctx = nullptr;
-    int rc = libusb_init(&ctx);
-    if (LIBUSB_SUCCESS != rc)
-    {
-        qWarning() << "libusb_init failed" << rc << libusb_error_name(rc);
-        return;
-    }
-
-    libusb_device **devs;
-    auto count = libusb_get_device_list(ctx, &devs);
+    int rc;
+    auto devs = QHIDUsbContext::devices(vendorId, deviceId);
 
-    for (ssize_t i = 0; i < count; ++i)
+    foreach (auto dev, devs)
     {
-        auto dev = devs[i];
-        libusb_device_descriptor desc;
-
-        if (libusb_get_device_descriptor(dev, &desc) < 0)
-            continue;
-
-        if (desc.idVendor != vendorId || desc.idProduct != deviceId)
-            continue;
-
         libusb_config_descriptor *confDesc = nullptr;
 
         if (libusb_get_active_config_descriptor(dev, &confDesc) < 0)
@@ -122,9 +48,13 @@ static void hidapiMissingFeatures(
 
         libusb_device_handle *handle;
         if (libusb_open(dev, &handle) < 0)
+        {
+            libusb_free_config_descriptor(confDesc);
             continue;
+        }
 
-        unsigned char buffer[256];
+        // The descriptor length is 16 bit, but the real ones are much shorter.
+        unsigned char buffer[4096];
         for (int iface = 0; iface < confDesc->bNumInterfaces; ++iface)
         {
             bool detached = false;
@@ -154,7 +84,13 @@ static void hidapiMissingFeatures(
             }
             else
             {
-                match = findUsage(usagePage, usage, buffer, rc);
+                match = QHIDDescriptor::findUsage(usagePage, usage, buffer, rc);
+
+                if (match && descriptor->parse(buffer, size_t(rc)))
+                {
+                    QHIDDescriptorCache::store(
+                        vendorId, deviceId, iface, QByteArray(reinterpret_cast<char *>(buffer), rc), *descriptor);
+                }
             }
 
             if (claimed)
@@ -199,56 +135,66 @@ static void hidapiMissingFeatures(
         break;
     }
 
-    libusb_free_device_list(devs, 1);
-    libusb_exit(ctx);
+    QHIDUsbContext::freeDevices(devs);
+    return false;
 }
 
 static void resetDevice(int vendorId, int deviceId)
 {
-    libusb_context *ctx = nullptr;
-    int rc = libusb_init(&ctx);
-    if (LIBUSB_SUCCESS != rc)
-    {
-        qWarning() << "libusb_init failed" << rc << libusb_error_name(rc);
-        return;
-    }
-
-    libusb_device **devs;
-    auto count = libusb_get_device_list(ctx, &devs);
+    auto devs = QHIDUsbContext::devices(vendorId, deviceId);
 
-    for (ssize_t i = 0; i < count; ++i)
+    if (!devs.empty())
     {
-        auto dev = devs[i];
-        libusb_device_descriptor desc;
-
-        if (libusb_get_device_descriptor(dev, &desc) < 0)
-            continue;
-
-        if (desc.idVendor != vendorId || desc.idProduct != deviceId)
-            continue;
-
         libusb_device_handle *handle;
-        if (libusb_open(dev, &handle) >= 0)
+        if (libusb_open(devs.front(), &handle) >= 0)
         {
             libusb_reset_device(handle);
             libusb_close(handle);
         }
-        break;
     }
 
-    libusb_free_device_list(devs, 1);
-    libusb_exit(ctx);
+    QHIDUsbContext::freeDevices(devs);
 }
 #endif
 
 static int hidapiUsed = 0;
 
+static hid_device *openDevice(int vendorId, int deviceId, int usagePage, int usage, int interfaceNumber)
+{
+    hid_device *device = nullptr;
+    auto devices = hid_enumerate(vendorId, deviceId);
+
+    for (auto dev = devices; dev != nullptr; dev = dev->next)
+    {
+        if ((dev->usage_page > 0 && dev->usage_page == usagePage && dev->usage == usage)
+            || (dev->interface_number >= 0 && dev->interface_number == interfaceNumber))
+        {
+            device = hid_open_path(dev->path);
+
+            if (device != nullptr)
+            {
+                break;
+            }
+
+            qWarning() << "Failed to open" << dev->path << "error" << errno;
+        }
+    }
+
+    hid_free_enumeration(devices);
+    return device;
+}
+
 QHIDDevicePrivate::QHIDDevicePrivate(QHIDDevice *q_ptr, int vendorId, int deviceId, int usagePage, int usage)
     : device(nullptr)
     , vendorId(vendorId)
     , deviceId(deviceId)
     , q_ptr(q_ptr)
 {
+#ifdef WITH_LIBUSB_1_0
+    // Keeps the device list between the reconnects.
+    QHIDUsbContext::acquire();
+#endif
+
     // Make sure we call hid_init() only once.
     if (hidapiUsed == 0 && hid_init() != 0)
     {
@@ -261,28 +207,32 @@ QHIDDevicePrivate::QHIDDevicePrivate(QHIDDevice *q_ptr, int vendorId, int device
 
     int interfaceNumber = -1;
 #ifdef WITH_LIBUSB_1_0
-    hidapiMissingFeatures(
-        vendorId, deviceId, usagePage, usage, &interfaceNumber, &q_ptr->inputBufferLength, &q_ptr->outputBufferLength);
+    auto cached = hidapiMissingFeatures(vendorId, deviceId, usagePage, usage, &interfaceNumber,
+        &q_ptr->inputBufferLength, &q_ptr->outputBufferLength, &q_ptr->descriptor, true);
 #endif
-    auto devices = hid_enumerate(vendorId, deviceId);
+    device = openDevice(vendorId, deviceId, usagePage, usage, interfaceNumber);
 
-    for (auto dev = devices; dev != nullptr; dev = dev->next)
+#ifdef WITH_LIBUSB_1_0
+    if (device == nullptr && cached)
     {
-        if ((dev->usage_page > 0 && dev->usage_page == usagePage && dev->usage == usage)
-            || (dev->interface_number >= 0 && dev->interface_number == interfaceNumber))
-        {
-            device = hid_open_path(dev->path);
-
-            if (device != nullptr)
-            {
-                break;
-            }
-
-            qWarning() << "Failed to open" << dev->path << "error" << errno;
-        }
+        // The cached interface is gone, maybe the firmware was updated.
+        QHIDDescriptorCache::remove(vendorId, deviceId, interfaceNumber);
+        interfaceNumber = -1;
+        q_ptr->descriptor = QHIDDescriptor();
+        hidapiMissingFeatures(vendorId, deviceId, usagePage, usage, &interfaceNumber, &q_ptr->inputBufferLength,
+            &q_ptr->outputBufferLength, &q_ptr->descriptor, false);
+        device = openDevice(vendorId, deviceId, usagePage, usage, interfaceNumber);
     }
+#endif
 
-    hid_free_enumeration(devices);
+    // The exact sizes instead of the endpoint packet sizes
+    auto inputSize = q_ptr->descriptor.maxReportSize(QHIDDescriptor::Input);
+    if (inputSize > 0)
+        q_ptr->inputBufferLength = inputSize + (q_ptr->descriptor.usesReportIds() ? 1 : 0);
+
+    auto outputSize = q_ptr->descriptor.maxReportSize(QHIDDescriptor::Output);
+    if (outputSize > 0)
+        q_ptr->outputBufferLength = outputSize;
 
     if (device == nullptr)
     {
@@ -310,6 +260,10 @@ QHIDDevicePrivate::~QHIDDevicePrivate()
     {
         hid_exit();
     }
+
+#ifdef WITH_LIBUSB_1_0
+    QHIDUsbContext::release();
+#endif
 }
 
 bool QHIDDevicePrivate::isValid() const
@@ -319,16 +273,20 @@ bool QHIDDevicePrivate::isValid() const
 
 int QHIDDevicePrivate::sendFeatureReport(const char *buffer, int length)
 {
+    // A stale errno must not look like a stall, see isTransientError().
+    errno = 0;
     return device == nullptr ? -1 : hid_send_feature_report(device, (const unsigned char *)buffer, size_t(length));
 }
 
 int QHIDDevicePrivate::getFeatureReport(char *buffer, int length)
 {
+    errno = 0;
     return device == nullptr ? -1 : hid_get_feature_report(device, (unsigned char *)buffer, size_t(length));
 }
 
 int QHIDDevicePrivate::write(const char *buffer, int length)
 {
+    errno = 0;
     return device == nullptr ? -1 : hid_write(device, (const unsigned char *)buffer, size_t(length));
 }
 
@@ -336,3 +294,37 @@ int QHIDDevicePrivate::read(char *buffer, int length, int timeout)
 {
     return device == nullptr ? -1 : hid_read_timeout(device, (unsigned char *)buffer, size_t(length), timeout);
 }
+
+bool QHIDDevicePrivate::isTransientError() const
+{
+    if (!device)
+        return false;
+
+    switch (errno)
+    {
+    case 0:
+#ifdef WITH_LIBUSB_1_0
+    {
+        // The libusb backend of hidapi returns -1 and keeps neither the libusb error nor errno.
+        // Still on the bus means a stall or a timeout, otherwise the device is gone.
+        auto devs = QHIDUsbContext::devices(vendorId, deviceId);
+        auto attached = !devs.empty();
+        QHIDUsbContext::freeDevices(devs);
+        return attached;
+    }
+#else
+        // Can't tell a stall from a removal without libusb, so it is not retried.
+        return false;
+#endif
+    case EPIPE:
+    case EAGAIN:
+    case EINTR:
+    case EBUSY:
+    case ETIMEDOUT:
+    case EPROTO:
+        return true;
+    }
+
+    // ENODEV, ESHUTDOWN & co: the device is gone.
+    return false;
+}
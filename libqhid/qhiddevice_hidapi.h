@@ -40,6 +40,9 @@ public:
     int write(const char *buffer, int length);
     int read(char *buffer, int length, int timeout);
 
+    // Whether the last failed call may succeed if retried. Must be called right after it.
+    bool isTransientError() const;
+
 private:
     hid_device *device;
     int vendorId;
@@ -20,6 +20,7 @@
 #include "qhiddevice_win32.h"
 
 #include <QDebug>
+#include <string.h>
 
 #include <SetupAPI.h>
 extern "C" {
@@ -187,9 +188,12 @@ int QHIDDevicePrivate::write(const char *buffer, int length)
         // Windows expects the number of bytes which are in the _longest_ report
         // (plus one for the report number) bytes even if the data is a report
         // which is shorter than that.
-        QByteArray tmp(buffer, length);
-        tmp.resize(q->outputBufferLength);
-        ret = WriteFile(hDevice, tmp.cbegin(), tmp.length(), &written, &overlapped);
+        if (outputBuffer.size() != q->outputBufferLength)
+            outputBuffer.resize(q->outputBufferLength);
+
+        memcpy(outputBuffer.data(), buffer, size_t(length));
+        memset(outputBuffer.data() + length, 0, size_t(q->outputBufferLength - length));
+        ret = WriteFile(hDevice, outputBuffer.cbegin(), outputBuffer.length(), &written, &overlapped);
     }
     else
     {
@@ -207,7 +211,9 @@ int QHIDDevicePrivate::write(const char *buffer, int length)
         return qMin((int)written, length);
     }
 
+    auto error = GetLastError();
     CancelIo(hDevice);
+    SetLastError(error);
     return -1;
 }
 
@@ -215,7 +221,10 @@ int QHIDDevicePrivate::read(char *buffer, int length, unsigned int timeout)
 {
     Q_Q(QHIDDevice);
     DWORD read = 0;
-    QByteArray tmp(q->inputBufferLength, Qt::Uninitialized);
+    if (inputBuffer.size() != q->inputBufferLength)
+        inputBuffer.resize(q->inputBufferLength);
+
+    auto &tmp = inputBuffer;
 
     ResetEvent(overlapped.hEvent);
     auto ret = ReadFile(hDevice, tmp.begin(), tmp.length(), &read, &overlapped);
@@ -228,6 +237,12 @@ int QHIDDevicePrivate::read(char *buffer, int length, unsigned int timeout)
             {
                 ret = GetOverlappedResult(hDevice, &overlapped, &read, true);
             }
+            else if (ret == WAIT_TIMEOUT)
+            {
+                // No data yet, same as hid_read_timeout does.
+                CancelIo(hDevice);
+                return 0;
+            }
         }
     }
 
@@ -251,6 +266,26 @@ int QHIDDevicePrivate::read(char *buffer, int length, unsigned int timeout)
         return length;
     }
 
+    auto error = GetLastError();
     CancelIo(hDevice);
+    SetLastError(error);
     return -1;
 }
+
+bool QHIDDevicePrivate::isTransientError() const
+{
+    if (!isValid())
+        return false;
+
+    switch (GetLastError())
+    {
+    case ERROR_GEN_FAILURE:
+    case ERROR_BUSY:
+    case ERROR_SEM_TIMEOUT:
+    case ERROR_OPERATION_ABORTED:
+        return true;
+    }
+
+    // ERROR_DEVICE_NOT_CONNECTED & co: the device is gone.
+    return false;
+}
@@ -40,9 +40,16 @@ public:
     int write(const char *buffer, int length);
     int read(char *buffer, int length, unsigned int timeout);
 
+    // Whether the last failed call may succeed if retried. Must be called right after it.
+    bool isTransientError() const;
+
 private:
     HANDLE hDevice;
     OVERLAPPED overlapped;
+    // The short reports padded to the longest one
+    QByteArray outputBuffer;
+    // The input report is read whole, then the zero id is stripped
+    QByteArray inputBuffer;
     QHIDDevice *q_ptr;
 };
 
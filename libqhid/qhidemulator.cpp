@@ -0,0 +1,261 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "qhidemulator.h"
+#include "qhidmonitor.h"
+
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <vector>
+
+#include <limits.h>
+#include <string.h>
+
+struct EmulatorState
+{
+    EmulatorState()
+        : connected(true)
+        , latency(0)
+        , failAfter(-1)
+        , stalls(0)
+        , silentErrors(false)
+        , transactions(0)
+        , opened(0)
+    {
+    }
+
+    QMutex mutex;
+    QWaitCondition inputReady;
+    bool connected;
+    int latency;
+    int failAfter;
+    int stalls;
+    bool silentErrors;
+    int transactions;
+    int opened;
+    std::map<int, QByteArray> reports;
+    std::deque<QByteArray> inputReports;
+    std::vector<QHIDMonitor *> monitors;
+};
+
+static EmulatorState &state()
+{
+    static EmulatorState instance;
+    return instance;
+}
+
+void QHIDEmulator::reset()
+{
+    auto &s = state();
+    QMutexLocker lock(&s.mutex);
+    s.connected = true;
+    s.latency = 0;
+    s.failAfter = -1;
+    s.stalls = 0;
+    s.silentErrors = false;
+    s.transactions = 0;
+    s.reports.clear();
+    s.inputReports.clear();
+}
+
+void QHIDEmulator::setConnected(bool value)
+{
+    auto &s = state();
+    std::vector<QHIDMonitor *> monitors;
+    {
+        QMutexLocker lock(&s.mutex);
+        if (s.connected == value)
+            return;
+
+        s.connected = value;
+        monitors = s.monitors;
+        s.inputReports.clear();
+        s.inputReady.wakeAll();
+    }
+
+    // Same as the real monitors do, but synchronously.
+    foreach (auto monitor, monitors)
+    {
+        if (value)
+            emit monitor->deviceArrival("emulated");
+        else
+            emit monitor->deviceRemove();
+    }
+}
+
+bool QHIDEmulator::isConnected()
+{
+    auto &s = state();
+    QMutexLocker lock(&s.mutex);
+    return s.connected;
+}
+
+void QHIDEmulator::setLatency(int usec)
+{
+    auto &s = state();
+    QMutexLocker lock(&s.mutex);
+    s.latency = usec;
+}
+
+int QHIDEmulator::latency()
+{
+    auto &s = state();
+    QMutexLocker lock(&s.mutex);
+    return s.latency;
+}
+
+void QHIDEmulator::setFailAfter(int count)
+{
+    auto &s = state();
+    QMutexLocker lock(&s.mutex);
+    s.failAfter = count;
+}
+
+void QHIDEmulator::setStallCount(int count)
+{
+    auto &s = state();
+    QMutexLocker lock(&s.mutex);
+    s.stalls = count;
+}
+
+void QHIDEmulator::setSilentErrors(bool value)
+{
+    auto &s = state();
+    QMutexLocker lock(&s.mutex);
+    s.silentErrors = value;
+}
+
+bool QHIDEmulator::silentErrors()
+{
+    auto &s = state();
+    QMutexLocker lock(&s.mutex);
+    return s.silentErrors;
+}
+
+void QHIDEmulator::setFeatureReport(const QByteArray &report)
+{
+    Q_ASSERT(!report.isEmpty());
+
+    auto &s = state();
+    QMutexLocker lock(&s.mutex);
+    s.reports[0xFF & report.at(0)] = report;
+}
+
+QByteArray QHIDEmulator::featureReport(int id)
+{
+    auto &s = state();
+    QMutexLocker lock(&s.mutex);
+    auto iter = s.reports.find(id);
+    return iter == s.reports.end() ? QByteArray() : iter->second;
+}
+
+void QHIDEmulator::pushInputReport(const QByteArray &report)
+{
+    Q_ASSERT(!report.isEmpty());
+
+    auto &s = state();
+    QMutexLocker lock(&s.mutex);
+    s.inputReports.push_back(report);
+    s.inputReady.wakeOne();
+}
+
+int QHIDEmulator::pendingInputReports()
+{
+    auto &s = state();
+    QMutexLocker lock(&s.mutex);
+    return int(s.inputReports.size());
+}
+
+int QHIDEmulator::transactionCount()
+{
+    auto &s = state();
+    QMutexLocker lock(&s.mutex);
+    return s.transactions;
+}
+
+int QHIDEmulator::openCount()
+{
+    auto &s = state();
+    QMutexLocker lock(&s.mutex);
+    return s.opened;
+}
+
+void QHIDEmulator::opened(int delta)
+{
+    auto &s = state();
+    QMutexLocker lock(&s.mutex);
+    s.opened += delta;
+}
+
+bool QHIDEmulator::transaction()
+{
+    auto &s = state();
+    int latency;
+    bool ok;
+    {
+        QMutexLocker lock(&s.mutex);
+        ++s.transactions;
+        latency = s.latency;
+        ok = s.connected && s.failAfter != 0 && s.stalls == 0;
+        if (s.failAfter > 0)
+            --s.failAfter;
+        if (s.stalls > 0)
+            --s.stalls;
+    }
+
+    // The bus is busy, not the emulator
+    if (latency > 0)
+        QThread::usleep(ulong(latency));
+
+    return ok;
+}
+
+int QHIDEmulator::takeInputReport(char *buffer, int length, int timeout)
+{
+    auto &s = state();
+    QMutexLocker lock(&s.mutex);
+
+    if (s.connected && s.inputReports.empty() && timeout != 0)
+        s.inputReady.wait(&s.mutex, timeout < 0 ? ULONG_MAX : ulong(timeout));
+
+    if (!s.connected)
+        return -1;
+
+    if (s.inputReports.empty())
+        return 0;
+
+    length = qMin(length, s.inputReports.front().size());
+    memcpy(buffer, s.inputReports.front().constData(), size_t(length));
+    s.inputReports.pop_front();
+    return length;
+}
+
+void QHIDEmulator::registerMonitor(QHIDMonitor *monitor, bool add)
+{
+    auto &s = state();
+    QMutexLocker lock(&s.mutex);
+
+    if (add)
+        s.monitors.push_back(monitor);
+    else
+        s.monitors.erase(std::remove(s.monitors.begin(), s.monitors.end(), monitor), s.monitors.end());
+}
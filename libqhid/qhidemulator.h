@@ -0,0 +1,74 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QHIDEMULATOR_H
+#define QHIDEMULATOR_H
+
+#include <QByteArray>
+
+// An in-memory device for the tests and the benchmarks. It is built instead of the real
+// backends with DEFINES += WITH_EMULATED_HID. The feature reports are kept by the report id
+// (the first byte), whatever is sent is read back.
+class QHIDEmulator
+{
+public:
+    // Back to a plugged in device without any reports and delays.
+    static void reset();
+
+    // Opening an unplugged device fails, so does any I/O. The monitors are notified.
+    static void setConnected(bool value);
+    static bool isConnected();
+
+    // Every transaction takes that long, usec
+    static void setLatency(int usec);
+    static int latency();
+
+    // The transactions start to fail after that many more succeed, -1 to never fail.
+    static void setFailAfter(int count);
+
+    // The next count transactions stall (EPIPE), as during a hotplug race, then it recovers.
+    static void setStallCount(int count);
+
+    // The failures leave errno at 0, as the hidapi-libusb backend does.
+    static void setSilentErrors(bool value);
+    static bool silentErrors();
+
+    static void setFeatureReport(const QByteArray &report);
+    static QByteArray featureReport(int id);
+
+    // Queues an input report, the readers get them in order.
+    static void pushInputReport(const QByteArray &report);
+    static int pendingInputReports();
+
+    static int transactionCount();
+    // The number of the device instances currently open
+    static int openCount();
+
+    //
+    // The backend side
+    //
+    static void opened(int delta);
+    // Emulates a transaction, returns false if it fails.
+    static bool transaction();
+    // Waits for the next input report up to timeout msec (forever if negative).
+    // Returns the length, 0 on timeout or -1 if unplugged.
+    static int takeInputReport(char *buffer, int length, int timeout);
+    static void registerMonitor(class QHIDMonitor *monitor, bool add);
+};
+
+#endif // QHIDEMULATOR_H
@@ -0,0 +1,109 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "qhidflightrecorder.h"
+#include "qhidtrace.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+
+#include <string.h>
+
+Q_STATIC_ASSERT_X((QHIDFlightRecorder::Size & (QHIDFlightRecorder::Size - 1)) == 0, "Size must be a power of two");
+
+static QHIDFlightRecorder::Entry entries[QHIDFlightRecorder::Size];
+// The total number of the recorded entries, the next one goes to (count % Size)
+static QAtomicInt count;
+
+void QHIDFlightRecorder::record(int operation, qint64 start, qint64 end, int report, int length, int result, int error)
+{
+    auto index = count.fetchAndAddRelaxed(1) & (Size - 1);
+    auto &entry = entries[index];
+    entry.start = start;
+    entry.end = end;
+    entry.operation = qint16(operation);
+    entry.report = qint16(report);
+    entry.length = length;
+    entry.result = result;
+    entry.error = error;
+}
+
+int QHIDFlightRecorder::snapshot(Entry *buffer, int maxCount)
+{
+    int total = count.load();
+    int n = qMin(qMin(total, int(Size)), maxCount);
+
+    for (int i = 0; i < n; ++i)
+    {
+        buffer[i] = entries[(total - n + i) & (Size - 1)];
+    }
+
+    return n;
+}
+
+bool QHIDFlightRecorder::dump(const QString &path, const QString &reason)
+{
+    // The probe & the GUI threads may dump at the same time, so the copy is not shared
+    Entry copy[Size];
+    auto n = snapshot(copy, Size);
+    if (n == 0)
+        return false;
+
+    QFile file(path);
+    if (!file.open(QFile::WriteOnly | QFile::Text))
+        return false;
+
+    QTextStream out(&file);
+    out << "# " << QCoreApplication::applicationName() << ' ' << QCoreApplication::applicationVersion() << ": "
+        << reason << '\n';
+    out << "# the last " << n << " device transactions, the times are msec since the start\n";
+    out << "start\tduration\toperation\treport\tlength\tresult\terrno\n";
+
+    for (int i = 0; i < n; ++i)
+    {
+        const auto &entry = copy[i];
+        out << QString::number(entry.start / 1e6, 'f', 3) << '\t'
+            << QString::number((entry.end - entry.start) / 1e6, 'f', 3) << '\t'
+            << QHIDTrace::operationName(entry.operation) << '\t' << entry.report << '\t' << entry.length << '\t'
+            << entry.result << '\t' << entry.error;
+
+        if (entry.error)
+            out << " (" << strerror(entry.error) << ')';
+
+        out << '\n';
+    }
+
+    return out.status() == QTextStream::Ok;
+}
+
+QString QHIDFlightRecorder::defaultDumpPath()
+{
+    auto dir = QDir::temp();
+    auto prefix = QString("%1-io-").arg(QCoreApplication::applicationName());
+
+    // The names sort by the time, leave room for the new one.
+    auto dumps = dir.entryList(QStringList(prefix + "*.log"), QDir::Files, QDir::Name);
+    for (int i = 0; i <= dumps.size() - MaxDumps; ++i)
+        dir.remove(dumps[i]);
+
+    return dir.filePath(prefix + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss-zzz") + ".log");
+}
@@ -0,0 +1,60 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QHIDFLIGHTRECORDER_H
+#define QHIDFLIGHTRECORDER_H
+
+#include <QString>
+
+// Always keeps the last Size device transactions in a fixed ring, so there is something
+// to look at when an operation fails in the field. Recording neither allocates nor locks;
+// the concurrent writers may overwrite each other's oldest entries, which is fine here.
+class QHIDFlightRecorder
+{
+public:
+    enum Constants
+    {
+        Size = 256,
+        // The default dumps kept in the temp directory
+        MaxDumps = 10,
+    };
+
+    struct Entry
+    {
+        // nanoseconds, see QHIDTrace::now()
+        qint64 start;
+        qint64 end;
+        qint16 operation;
+        qint16 report;
+        int length;
+        int result;
+        int error;
+    };
+
+    static void record(int operation, qint64 start, qint64 end, int report, int length, int result, int error);
+
+    // Copies the entries, the oldest one first. Returns the number of entries.
+    static int snapshot(Entry *buffer, int maxCount);
+
+    // Writes the entries as text. Does nothing when there are none.
+    static bool dump(const QString &path, const QString &reason);
+    // A new file in the temp directory. The oldest ones are removed, so at most MaxDumps stay.
+    static QString defaultDumpPath();
+};
+
+#endif // QHIDFLIGHTRECORDER_H
@@ -17,7 +17,9 @@
  */
 
 #include "qhidmonitor.h"
-#if defined(WITH_LIBUSB_1_0)
+#if defined(WITH_EMULATED_HID)
+#include "qhidmonitor_emulated.h"
+#elif defined(WITH_LIBUSB_1_0)
 #include "qhidmonitor_libusb.h"
 #elif defined(WITH_LIBUDEV)
 #include "qhidmonitor_udev.h"
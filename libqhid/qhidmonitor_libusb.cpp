@@ -18,6 +18,7 @@
 
 #include "qhidmonitor.h"
 #include "qhidmonitor_libusb.h"
+#include "qhidusbcontext.h"
 
 #include <QDebug>
 
@@ -36,11 +37,13 @@ int LIBUSB_CALL QHIDMonitorPrivate::callback(
             str.append(QString::number(path.at(i))).append(":");
         }
         str.append(QString::number(libusb_get_device_address(device)));
-        emit(q->deviceArrival(str));
+
+        // The events are handled on the device lookup as well, maybe in the middle of open().
+        QMetaObject::invokeMethod(q, "deviceArrival", Qt::QueuedConnection, Q_ARG(QString, str));
     }
     else
     {
-        emit(q->deviceRemove());
+        QMetaObject::invokeMethod(q, "deviceRemove", Qt::QueuedConnection);
     }
 
     return 0;
@@ -51,16 +54,14 @@ QHIDMonitorPrivate::QHIDMonitorPrivate(QHIDMonitor *q_ptr, int vendorId, int dev
     , handle(0)
     , q_ptr(q_ptr)
 {
-    int rc = libusb_init(&ctx);
+    // Shared with the devices, so their device list gets the hotplug events too.
+    ctx = QHIDUsbContext::acquire();
 
-    if (LIBUSB_SUCCESS != rc)
-    {
-        qWarning() << "Error creating a context" << libusb_error_name(rc);
+    if (!ctx)
         return;
-    }
 
     auto events = (libusb_hotplug_event)(LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT);
-    rc = libusb_hotplug_register_callback(ctx, events, (libusb_hotplug_flag)0, vendorId, deviceId,
+    auto rc = libusb_hotplug_register_callback(ctx, events, (libusb_hotplug_flag)0, vendorId, deviceId,
         LIBUSB_HOTPLUG_MATCH_ANY, QHIDMonitorPrivate::callback, this, &handle);
 
     if (LIBUSB_SUCCESS != rc)
@@ -89,7 +90,7 @@ QHIDMonitorPrivate::~QHIDMonitorPrivate()
             handle = 0;
         }
 
-        libusb_exit(ctx);
+        QHIDUsbContext::release();
         ctx = nullptr;
     }
 }
@@ -97,6 +98,5 @@ QHIDMonitorPrivate::~QHIDMonitorPrivate()
 void QHIDMonitorPrivate::timerEvent(QTimerEvent *evt)
 {
     QObject::timerEvent(evt);
-    timeval tv = {0, 10000};
-    libusb_handle_events_timeout(ctx, &tv);
+    QHIDUsbContext::handleEvents();
 }
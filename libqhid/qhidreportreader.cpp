@@ -0,0 +1,99 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "qhidreportreader.h"
+#include "qhiddevice.h"
+
+#include <QDebug>
+
+// How often the reader checks for the stop request.
+#define POLL_INTERVAL 100
+
+QHIDReportReader::QHIDReportReader(QHIDDevice *device, QObject *parent)
+    : QThread(parent)
+    , device(device)
+    , notified(0)
+    , received(0)
+{
+    clock.start();
+}
+
+QHIDReportReader::~QHIDReportReader()
+{
+    stop();
+}
+
+void QHIDReportReader::stop()
+{
+    requestInterruption();
+    wait();
+}
+
+int QHIDReportReader::takeReports(QHIDReport *buffer, int maxCount)
+{
+    // Re-arm the notification first, so a report pushed right after the pop is not missed.
+    notified.storeRelease(0);
+    return ring.pop(buffer, maxCount);
+}
+
+int QHIDReportReader::receivedCount() const
+{
+    return received.load();
+}
+
+int QHIDReportReader::droppedCount() const
+{
+    return ring.droppedCount();
+}
+
+qint64 QHIDReportReader::timestamp() const
+{
+    return clock.nsecsElapsed();
+}
+
+void QHIDReportReader::run()
+{
+    QHIDReport report;
+    quint32 sequence = 0;
+
+    while (!isInterruptionRequested())
+    {
+        auto length = device->readReport(report.data, sizeof(report.data), POLL_INTERVAL);
+
+        if (length < 0)
+        {
+            qWarning() << "Failed to read the input report";
+            break;
+        }
+
+        if (length == 0)
+        {
+            // Timed out, check for the stop request.
+            continue;
+        }
+
+        report.timestamp = clock.nsecsElapsed();
+        report.sequence = sequence++;
+        report.length = length;
+        ring.push(report);
+        received.storeRelease(int(sequence));
+
+        if (notified.testAndSetOrdered(0, 1))
+            emit reportsAvailable();
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QHIDREPORTREADER_H
+#define QHIDREPORTREADER_H
+
+#include "qhidringbuffer.h"
+
+#include <QElapsedTimer>
+#include <QThread>
+
+struct QHIDReport
+{
+    qint64 timestamp; // nanoseconds, see QHIDReportReader::timestamp()
+    // Counts all the arrived reports, the dropped ones included, so a gap marks the drop.
+    quint32 sequence;
+    int length;
+    char data[64];
+};
+
+// Reads the input reports on a dedicated thread and timestamps them as soon as they arrive.
+// The backends give no kernel timestamps, so it is the time the read returned.
+class QHIDReportReader : public QThread
+{
+    Q_OBJECT
+
+public:
+    enum
+    {
+        BufferSize = 4096,
+    };
+
+    explicit QHIDReportReader(class QHIDDevice *device, QObject *parent = 0);
+    ~QHIDReportReader();
+
+    void stop();
+
+    int takeReports(QHIDReport *buffer, int maxCount);
+    // All the arrived reports, the dropped ones included
+    int receivedCount() const;
+    // Dropped because the consumer was too slow
+    int droppedCount() const;
+
+    qint64 timestamp() const;
+
+signals:
+    // Emitted once for a batch of reports, until the consumer takes them.
+    void reportsAvailable();
+
+protected:
+    void run();
+
+private:
+    class QHIDDevice *device;
+    QElapsedTimer clock;
+    QAtomicInt notified;
+    QAtomicInt received;
+    QHIDRingBuffer<QHIDReport, BufferSize> ring;
+};
+
+#endif // QHIDREPORTREADER_H
@@ -0,0 +1,105 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QHIDRINGBUFFER_H
+#define QHIDRINGBUFFER_H
+
+#include <QAtomicInt>
+
+// Lock-free ring buffer for exactly one producer thread and one consumer thread.
+// All the storage is allocated up front, so neither side ever allocates.
+template <typename T, int Size>
+class QHIDRingBuffer
+{
+    Q_STATIC_ASSERT_X((Size & (Size - 1)) == 0, "Size must be a power of two");
+
+public:
+    QHIDRingBuffer()
+        : head(0)
+        , tail(0)
+        , dropped(0)
+    {
+    }
+
+    // Producer side. Returns false (and counts the item as dropped) when the buffer is full.
+    bool push(const T &item)
+    {
+        int h = head.load();
+        if (distance(tail.loadAcquire(), h) == Size)
+        {
+            dropped.fetchAndAddRelaxed(1);
+            return false;
+        }
+
+        items[h & (Size - 1)] = item;
+        head.storeRelease(advance(h, 1));
+        return true;
+    }
+
+    // Consumer side. Returns the number of items copied.
+    int pop(T *buffer, int maxCount)
+    {
+        int t = tail.load();
+        int count = qMin(distance(t, head.loadAcquire()), maxCount);
+
+        for (int i = 0; i < count; ++i)
+        {
+            buffer[i] = items[advance(t, i) & (Size - 1)];
+        }
+
+        tail.storeRelease(advance(t, count));
+        return count;
+    }
+
+    int size() const
+    {
+        return distance(tail.loadAcquire(), head.loadAcquire());
+    }
+
+    int droppedCount() const
+    {
+        return dropped.load();
+    }
+
+    // Only safe when both sides are idle.
+    void clear()
+    {
+        head.store(0);
+        tail.store(0);
+        dropped.store(0);
+    }
+
+private:
+    // The counters are free running, so let them wrap around without overflow.
+    static int distance(int from, int to)
+    {
+        return int(unsigned(to) - unsigned(from));
+    }
+
+    static int advance(int value, int count)
+    {
+        return int(unsigned(value) + unsigned(count));
+    }
+
+    T items[Size];
+    QAtomicInt head;
+    QAtomicInt tail;
+    QAtomicInt dropped;
+};
+
+#endif // QHIDRINGBUFFER_H
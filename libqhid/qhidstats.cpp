@@ -0,0 +1,145 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "qhidstats.h"
+#include "qhidtrace.h"
+
+#include <QMutex>
+
+#include <string.h>
+
+static QMutex mutex;
+static QHIDStats::Counters operations[QHIDStats::NumOperations];
+
+int QHIDStats::bucket(qint64 usec)
+{
+    if (usec < LinearBuckets)
+        return int(qMax(qint64(0), usec));
+
+    int exponent = 4;
+    while (exponent < 31 && (usec >> (exponent + 1)) > 0)
+        ++exponent;
+
+    auto sub = int(qMin(usec >> (exponent - 3), qint64(2 * SubBuckets - 1))) & (SubBuckets - 1);
+    return LinearBuckets + (exponent - 4) * SubBuckets + sub;
+}
+
+qint64 QHIDStats::bucketValue(int bucket)
+{
+    if (bucket < LinearBuckets)
+        return bucket;
+
+    auto exponent = 4 + (bucket - LinearBuckets) / SubBuckets;
+    auto sub = (bucket - LinearBuckets) % SubBuckets;
+    auto width = qint64(1) << (exponent - 3);
+    return (qint64(1) << exponent) + sub * width + width / 2;
+}
+
+void QHIDStats::record(int operation, qint64 nsec, int result)
+{
+    if (operation < 0 || operation >= NumOperations)
+        return;
+
+    auto usec = nsec / 1000;
+    QMutexLocker lock(&mutex);
+    auto &counters = operations[operation];
+
+    ++counters.count;
+    if (result < 0)
+        ++counters.errors;
+    else if (operation != QHIDTrace::Sleep && operation != QHIDTrace::Backoff)
+        counters.bytes += result;
+
+    counters.totalTime += usec;
+    counters.maxTime = qMax(counters.maxTime, usec);
+    ++counters.histogram[bucket(usec)];
+}
+
+void QHIDStats::recordRetry(int operation)
+{
+    if (operation < 0 || operation >= NumOperations)
+        return;
+
+    QMutexLocker lock(&mutex);
+    ++operations[operation].retries;
+}
+
+QHIDStats::Counters QHIDStats::counters(int operation)
+{
+    Q_ASSERT(operation >= 0 && operation < NumOperations);
+
+    QMutexLocker lock(&mutex);
+    return operations[operation];
+}
+
+void QHIDStats::reset()
+{
+    QMutexLocker lock(&mutex);
+    memset(operations, 0, sizeof(operations));
+}
+
+qint64 QHIDStats::percentile(const Counters &counters, double value)
+{
+    auto threshold = value * counters.count / 100.0;
+    qint64 total = 0;
+
+    for (int i = 0; i < NumBuckets; ++i)
+    {
+        total += counters.histogram[i];
+        if (total > 0 && total >= threshold)
+            return qMin(bucketValue(i), counters.maxTime);
+    }
+
+    return counters.maxTime;
+}
+
+QJsonObject QHIDStats::toJson()
+{
+    QJsonObject json;
+    qint64 ioTime = 0;
+
+    for (int operation = 0; operation < NumOperations; ++operation)
+    {
+        auto c = counters(operation);
+
+        QJsonObject latency;
+        latency["mean"] = c.count ? double(c.totalTime) / c.count : 0.0;
+        latency["p50"] = double(percentile(c, 50));
+        latency["p90"] = double(percentile(c, 90));
+        latency["p99"] = double(percentile(c, 99));
+        latency["max"] = double(c.maxTime);
+
+        QJsonObject item;
+        item["count"] = double(c.count);
+        item["errors"] = double(c.errors);
+        item["retries"] = double(c.retries);
+        item["bytes"] = double(c.bytes);
+        item["total_ms"] = c.totalTime / 1000.0;
+        item["latency_us"] = latency;
+        json[QHIDTrace::operationName(operation)] = item;
+
+        if (operation != QHIDTrace::Sleep && operation != QHIDTrace::Backoff)
+            ioTime += c.totalTime;
+    }
+
+    // The answer to "round-trips or delays?"
+    json["io_ms"] = ioTime / 1000.0;
+    json["pacing_ms"] = counters(QHIDTrace::Sleep).totalTime / 1000.0;
+    json["backoff_ms"] = counters(QHIDTrace::Backoff).totalTime / 1000.0;
+    return json;
+}
@@ -0,0 +1,64 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QHIDSTATS_H
+#define QHIDSTATS_H
+
+#include <QJsonObject>
+
+// Counters and latency histograms of the device I/O, per QHIDTrace::Operation.
+// The histograms are HDR style: exact below 16 usec, then 8 sub-buckets per power of two,
+// so any latency from 1 usec to ~35 minutes is kept within 12.5%.
+class QHIDStats
+{
+public:
+    enum Constants
+    {
+        NumOperations = 6,
+        LinearBuckets = 16,
+        SubBuckets = 8,
+        NumBuckets = LinearBuckets + (31 - 4 + 1) * SubBuckets,
+    };
+
+    struct Counters
+    {
+        qint64 count;
+        qint64 errors;
+        qint64 retries;
+        qint64 bytes;
+        // usec
+        qint64 totalTime;
+        qint64 maxTime;
+        qint64 histogram[NumBuckets];
+    };
+
+    static void record(int operation, qint64 nsec, int result);
+    static void recordRetry(int operation);
+    static Counters counters(int operation);
+    static void reset();
+
+    // usec
+    static qint64 percentile(const Counters &counters, double value);
+    static QJsonObject toJson();
+
+    static int bucket(qint64 usec);
+    // The middle of the bucket, usec
+    static qint64 bucketValue(int bucket);
+};
+
+#endif // QHIDSTATS_H
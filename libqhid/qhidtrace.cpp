@@ -0,0 +1,128 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "qhidtrace.h"
+#include "qhidflightrecorder.h"
+#include "qhidstats.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QThread>
+#include <vector>
+
+#include <errno.h>
+
+// Set from the GUI, read by the I/O threads
+static QAtomicInt enabled;
+static QMutex mutex;
+static std::vector<QHIDTrace::Event> events;
+
+static const QElapsedTimer &traceClock()
+{
+    struct Clock : public QElapsedTimer
+    {
+        Clock()
+        {
+            start();
+        }
+    };
+
+    static Clock instance;
+    return instance;
+}
+
+void QHIDTrace::setEnabled(bool value)
+{
+    // Start the clock before the first event
+    now();
+    enabled.store(value);
+}
+
+bool QHIDTrace::isEnabled()
+{
+    return enabled.load() != 0;
+}
+
+qint64 QHIDTrace::now()
+{
+    return traceClock().nsecsElapsed();
+}
+
+void QHIDTrace::record(Operation operation, qint64 start, int report, int length, int result)
+{
+    // Before anything else may change it
+    auto error = result < 0 ? errno : 0;
+    auto end = now();
+
+    // The flight recorder and the statistics are always on
+    QHIDFlightRecorder::record(operation, start, end, report, length, result, error);
+    QHIDStats::record(operation, end - start, result);
+
+    if (!enabled.load())
+        return;
+
+    Event event = {start, end, operation, report, length, result, quintptr(QThread::currentThreadId())};
+    QMutexLocker lock(&mutex);
+    events.push_back(event);
+}
+
+const char *QHIDTrace::operationName(int operation)
+{
+    static const char *names[] = {"getFeatureReport", "sendFeatureReport", "write", "read", "sleep", "backoff"};
+    return operation >= 0 && operation <= Backoff ? names[operation] : "?";
+}
+
+bool QHIDTrace::save(const QString &path)
+{
+    QJsonArray traceEvents;
+    {
+        QMutexLocker lock(&mutex);
+        foreach (const auto &event, events)
+        {
+            QJsonObject args;
+            args["report"] = event.report;
+            args["length"] = event.length;
+            args["result"] = event.result;
+
+            QJsonObject item;
+            item["name"] = QString(operationName(event.operation));
+            item["cat"] = QString(event.operation == Sleep ? "pacing" : event.operation == Backoff ? "retry" : "usb");
+            item["ph"] = QString("X");
+            // The trace format is in microseconds
+            item["ts"] = event.start / 1000.0;
+            item["dur"] = (event.end - event.start) / 1000.0;
+            item["pid"] = int(QCoreApplication::applicationPid());
+            item["tid"] = double(event.thread);
+            item["args"] = args;
+            traceEvents.append(item);
+        }
+    }
+
+    QJsonObject json;
+    json["traceEvents"] = traceEvents;
+    json["displayTimeUnit"] = QString("ms");
+
+    QFile file(path);
+    return file.open(QFile::WriteOnly) && file.write(QJsonDocument(json).toJson(QJsonDocument::Compact)) > 0;
+}
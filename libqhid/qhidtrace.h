@@ -0,0 +1,68 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QHIDTRACE_H
+#define QHIDTRACE_H
+
+#include <QString>
+
+// Records every device transaction with the start & end timestamps and exports them
+// in the Chrome trace event format (chrome://tracing, ui.perfetto.dev).
+// Off by default; once enabled, the events are kept in memory until saved.
+// The events are passed to QHIDFlightRecorder and QHIDStats regardless.
+class QHIDTrace
+{
+public:
+    enum Operation
+    {
+        GetFeatureReport,
+        SendFeatureReport,
+        Write,
+        Read,
+        // The write pacing
+        Sleep,
+        // The wait before a retry
+        Backoff,
+    };
+
+    struct Event
+    {
+        // nanoseconds, see now()
+        qint64 start;
+        qint64 end;
+        int operation;
+        // The report id, that is the page for the feature reports, -1 if unknown
+        int report;
+        int length;
+        int result;
+        quintptr thread;
+    };
+
+    static void setEnabled(bool value);
+    static bool isEnabled();
+
+    // Monotonic nanoseconds since the first call.
+    static qint64 now();
+
+    static void record(Operation operation, qint64 start, int report, int length, int result);
+    static bool save(const QString &path);
+
+    static const char *operationName(int operation);
+};
+
+#endif // QHIDTRACE_H
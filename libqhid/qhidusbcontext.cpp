@@ -0,0 +1,176 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "qhidusbcontext.h"
+
+#include <QDebug>
+#include <QMutex>
+#include <algorithm>
+
+// Recursive, since the hotplug callback is called from libusb_hotplug_register_callback
+// for the already attached devices.
+static QMutex mutex(QMutex::Recursive);
+static libusb_context *ctx = nullptr;
+static int refCount = 0;
+static bool hotplug = false;
+static libusb_hotplug_callback_handle callbackHandle;
+static std::vector<libusb_device *> attached;
+
+static int LIBUSB_CALL onHotplug(libusb_context *, libusb_device *device, libusb_hotplug_event event, void *)
+{
+    QMutexLocker lock(&mutex);
+    auto iter = std::find(attached.begin(), attached.end(), device);
+
+    if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED)
+    {
+        if (iter == attached.end())
+            attached.push_back(libusb_ref_device(device));
+    }
+    else if (iter != attached.end())
+    {
+        libusb_unref_device(*iter);
+        attached.erase(iter);
+    }
+
+    return 0;
+}
+
+static bool matches(libusb_device *device, int vendorId, int deviceId)
+{
+    // The device descriptor is cached by libusb, no I/O here.
+    libusb_device_descriptor desc;
+    return libusb_get_device_descriptor(device, &desc) == 0 && desc.idVendor == vendorId
+        && desc.idProduct == deviceId;
+}
+
+libusb_context *QHIDUsbContext::acquire()
+{
+    QMutexLocker lock(&mutex);
+
+    if (refCount > 0)
+    {
+        ++refCount;
+        return ctx;
+    }
+
+    int rc = libusb_init(&ctx);
+    if (LIBUSB_SUCCESS != rc)
+    {
+        qWarning() << "libusb_init failed" << rc << libusb_error_name(rc);
+        ctx = nullptr;
+        return nullptr;
+    }
+
+    ++refCount;
+
+    // Without the hotplug the bus is scanned on every lookup.
+    if (libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG))
+    {
+        auto events = (libusb_hotplug_event)(LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT);
+        rc = libusb_hotplug_register_callback(ctx, events, LIBUSB_HOTPLUG_ENUMERATE, LIBUSB_HOTPLUG_MATCH_ANY,
+            LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY, onHotplug, nullptr, &callbackHandle);
+        hotplug = LIBUSB_SUCCESS == rc;
+
+        if (!hotplug)
+            qWarning() << "Error creating a hotplug callback" << libusb_error_name(rc);
+    }
+
+    return ctx;
+}
+
+void QHIDUsbContext::release()
+{
+    QMutexLocker lock(&mutex);
+
+    if (refCount == 0 || --refCount > 0)
+        return;
+
+    if (hotplug)
+    {
+        libusb_hotplug_deregister_callback(ctx, callbackHandle);
+        hotplug = false;
+    }
+
+    freeDevices(attached);
+    attached.clear();
+    libusb_exit(ctx);
+    ctx = nullptr;
+}
+
+std::vector<libusb_device *> QHIDUsbContext::devices(int vendorId, int deviceId)
+{
+    std::vector<libusb_device *> ret;
+
+    // Not under the lock: the monitor may be handling the events in another thread,
+    // and our callback waits for the lock then.
+    handleEvents();
+
+    QMutexLocker lock(&mutex);
+
+    if (!ctx)
+        return ret;
+
+    if (hotplug)
+    {
+        foreach (auto device, attached)
+        {
+            if (matches(device, vendorId, deviceId))
+                ret.push_back(libusb_ref_device(device));
+        }
+
+        return ret;
+    }
+
+    libusb_device **devs;
+    auto count = libusb_get_device_list(ctx, &devs);
+
+    for (ssize_t i = 0; i < count; ++i)
+    {
+        if (matches(devs[i], vendorId, deviceId))
+            ret.push_back(libusb_ref_device(devs[i]));
+    }
+
+    if (count >= 0)
+        libusb_free_device_list(devs, 1);
+
+    return ret;
+}
+
+void QHIDUsbContext::freeDevices(const std::vector<libusb_device *> &devices)
+{
+    foreach (auto device, devices)
+        libusb_unref_device(device);
+}
+
+void QHIDUsbContext::handleEvents()
+{
+    libusb_context *context;
+    {
+        // Hold a reference, so a concurrent final release() can't exit the context meanwhile.
+        QMutexLocker lock(&mutex);
+        if (refCount == 0)
+            return;
+
+        ++refCount;
+        context = ctx;
+    }
+
+    timeval tv = {0, 0};
+    libusb_handle_events_timeout_completed(context, &tv, nullptr);
+    release();
+}
@@ -0,0 +1,43 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef QHIDUSBCONTEXT_H
+#define QHIDUSBCONTEXT_H
+
+#include <libusb.h>
+#include <vector>
+
+// The process wide libusb context, shared by the device & the monitor backends.
+// It keeps the list of the attached devices up to date with the hotplug events,
+// so looking for a device does not scan the bus.
+class QHIDUsbContext
+{
+public:
+    // Takes a reference, returns null if libusb can't be initialized.
+    static libusb_context *acquire();
+    static void release();
+
+    // The attached devices with that VID & PID. They are referenced, call freeDevices() when done.
+    static std::vector<libusb_device *> devices(int vendorId, int deviceId);
+    static void freeDevices(const std::vector<libusb_device *> &devices);
+
+    // Processes the pending events without waiting.
+    static void handleEvents();
+};
+
+#endif // QHIDUSBCONTEXT_H
@@ -0,0 +1,357 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "buttonbinding.h"
+#include "usbscancodes.h"
+
+#include <qxtglobal.h>
+#include <QStringList>
+
+struct NamedValue
+{
+    const char *name;
+    int value;
+};
+
+static const char *modifierNames[ButtonBinding::NumModifiers] =
+{
+    QT_TRANSLATE_NOOP("ButtonEdit", "LCtrl"),
+    QT_TRANSLATE_NOOP("ButtonEdit", "LShift"),
+    QT_TRANSLATE_NOOP("ButtonEdit", "LAlt"),
+    QT_TRANSLATE_NOOP("ButtonEdit", "LSuper"),
+    QT_TRANSLATE_NOOP("ButtonEdit", "RCtrl"),
+    QT_TRANSLATE_NOOP("ButtonEdit", "RShift"),
+    QT_TRANSLATE_NOOP("ButtonEdit", "RAlt"),
+    QT_TRANSLATE_NOOP("ButtonEdit", "RSuper"),
+};
+
+static const NamedValue events[] =
+{
+    {"key",          MS794::EventKey},
+    {"button",       MS794::EventButton},
+    {"profile",      MS794::EventProfile},
+    {"macro",        MS794::EventMacro},
+    {"sequence",     MS794::EventSequence},
+    {"triple-click", MS794::EventTripleClick},
+    {"disabled",     MS794::EventDisabled},
+    {"custom",       MS794::EventCustom},
+};
+
+static const NamedValue mouseButtons[] =
+{
+    {"left",    MS794::MouseLeftButton},
+    {"right",   MS794::MouseRightButton},
+    {"middle",  MS794::MouseMiddleButton},
+    {"back",    MS794::MouseBackButton},
+    {"forward", MS794::MouseForwardButton},
+};
+
+static const NamedValue profileChanges[] =
+{
+    {"next",     MS794::NextProfile},
+    {"previous", MS794::PreviousProfile},
+    {"cycle",    MS794::CycleProfile},
+};
+
+static const NamedValue repeatModes[] =
+{
+    {"count",          MS794::MacroRepeatCount},
+    {"until-next-key", MS794::MacroRepeatUntilNextKey},
+    {"until-released", MS794::MacroRepeatWhileHold},
+};
+
+template <size_t N> static const char *findName(const NamedValue (&table)[N], int value)
+{
+    for (size_t i = 0; i < N; ++i)
+    {
+        if (table[i].value == value)
+            return table[i].name;
+    }
+
+    return nullptr;
+}
+
+template <size_t N> static int findValue(const NamedValue (&table)[N], const QString &name)
+{
+    for (size_t i = 0; i < N; ++i)
+    {
+        if (name.compare(table[i].name, Qt::CaseInsensitive) == 0)
+            return table[i].value;
+    }
+
+    return -1;
+}
+
+static QString hex(int value)
+{
+    return QString("0x%1").arg(value, 2, 16, QChar('0'));
+}
+
+// Accepts both decimal and 0x prefixed hex numbers, returns -1 on error.
+static int parseNumber(const QString &text, int max)
+{
+    bool ok = false;
+    auto value = text.toInt(&ok, 0);
+    return ok && value >= 0 && value <= max ? value : -1;
+}
+
+static QString keyName(int code)
+{
+    auto name = UsbScanCodes::name(code);
+    return *name ? QString(name) : hex(code);
+}
+
+static int keyCode(const QString &name)
+{
+    auto code = UsbScanCodes::code(name);
+    return code < 0 ? parseNumber(name, 0xFF) : code;
+}
+
+// The key names may contain the '+' itself ("Keypad +", "Keypad +/-"),
+// so try the longest name first and backtrack on failure.
+static bool parseKeys(const QString &text, int *modifiers, std::vector<int> *keys)
+{
+    for (int end = text.length(); end > 0; --end)
+    {
+        if (end < text.length() && text[end] != '+')
+            continue;
+
+        auto name = text.left(end).trimmed();
+        auto modifier = -1;
+        auto code = -1;
+
+        for (int bit = 0; bit < ButtonBinding::NumModifiers; ++bit)
+        {
+            if (name.compare(modifierNames[bit], Qt::CaseInsensitive) == 0)
+                modifier = 1 << bit;
+        }
+
+        if (modifier < 0 && (code = keyCode(name)) < 0)
+            continue;
+
+        auto savedModifiers = *modifiers;
+        auto savedSize = keys->size();
+
+        if (modifier < 0)
+            keys->push_back(code);
+        else
+            *modifiers |= modifier;
+
+        if (end == text.length() || parseKeys(text.mid(end + 1), modifiers, keys))
+            return true;
+
+        *modifiers = savedModifiers;
+        keys->resize(savedSize);
+    }
+
+    return false;
+}
+
+const char *ButtonBinding::modifierName(int bit)
+{
+    return bit >= 0 && bit < NumModifiers ? modifierNames[bit] : "";
+}
+
+bool ButtonBinding::isValid() const
+{
+    switch (event())
+    {
+    case MS794::EventKey:
+        return key1() < UsbScanCodes::itemCount() && key2() < UsbScanCodes::itemCount()
+            && (key1() || key2() || modifiers());
+
+    case MS794::EventButton:
+        return findName(mouseButtons, mouseButton()) != nullptr;
+
+    case MS794::EventProfile:
+        return findName(profileChanges, profileChange()) != nullptr
+            || (profileChange() > MS794::LockToProfile && profileChange() <= MS794::LockToProfile + MaxDpiLock);
+
+    case MS794::EventMacro:
+        return macroIndex() >= 1 && macroIndex() <= MS794::MaxMacroNum && findName(repeatModes, repeatMode());
+
+    case MS794::EventSequence:
+        return key1() > 0 && key1() < UsbScanCodes::itemCount() && sequenceCount() > 0;
+
+    case MS794::EventTripleClick:
+        return true;
+
+    case MS794::EventDisabled:
+        return arg1() == 1;
+    }
+
+    return false;
+}
+
+QString ButtonBinding::toString() const
+{
+    QStringList parts;
+
+    switch (event())
+    {
+    case MS794::EventKey:
+        for (int bit = 0; bit < NumModifiers; ++bit)
+        {
+            if (modifiers() & (1 << bit))
+                parts << modifierNames[bit];
+        }
+
+        if (key1())
+            parts << keyName(key1());
+
+        if (key2())
+            parts << keyName(key2());
+
+        return QString("key %1").arg(parts.join('+')).trimmed();
+
+    case MS794::EventButton:
+    {
+        auto name = findName(mouseButtons, mouseButton());
+        return QString("button %1").arg(name ? QString(name) : hex(mouseButton()));
+    }
+
+    case MS794::EventProfile:
+    {
+        auto name = findName(profileChanges, profileChange());
+        if (name)
+            return QString("profile %1").arg(name);
+
+        if (profileChange() & MS794::LockToProfile)
+            return QString("profile lock %1").arg(profileChange() & ~MS794::LockToProfile);
+
+        return QString("profile %1").arg(hex(profileChange()));
+    }
+
+    case MS794::EventMacro:
+    {
+        auto name = findName(repeatModes, repeatMode());
+        return QString("macro %1 %2").arg(macroIndex()).arg(name ? QString(name) : hex(repeatMode()));
+    }
+
+    case MS794::EventSequence:
+        return QString("sequence %1x %2ms %3").arg(sequenceCount()).arg(sequenceDelay()).arg(keyName(key1()));
+
+    case MS794::EventTripleClick:
+        return "triple-click";
+
+    case MS794::EventDisabled:
+        return "disabled";
+    }
+
+    return QString("custom 0x%1").arg(value() & ~0x0Fu, 8, 16, QChar('0'));
+}
+
+ButtonBinding ButtonBinding::fromString(const QString &text, bool *ok)
+{
+    auto trimmed = text.simplified();
+    auto space = trimmed.indexOf(' ');
+    auto name = trimmed.left(space);
+    auto args = space < 0 ? QString() : trimmed.mid(space + 1);
+    auto argList = args.split(' ', QString::SkipEmptyParts);
+    ButtonBinding ret;
+
+    switch (findValue(events, name))
+    {
+    case MS794::EventKey:
+    {
+        int mask = 0;
+        std::vector<int> keys;
+
+        if (!args.isEmpty() && (!parseKeys(args, &mask, &keys) || keys.size() > 2))
+            break;
+
+        keys.resize(2, 0);
+        ret = key(mask, keys[0], keys[1]);
+        break;
+    }
+
+    case MS794::EventButton:
+    {
+        auto value = findValue(mouseButtons, args);
+        if (value > 0)
+            ret = button(value);
+        break;
+    }
+
+    case MS794::EventProfile:
+        if (argList.size() == 2 && argList[0].compare("lock", Qt::CaseInsensitive) == 0)
+        {
+            auto value = parseNumber(argList[1], MaxDpiLock);
+            if (value > 0)
+                ret = dpiLock(value);
+        }
+        else
+        {
+            auto value = findValue(profileChanges, args);
+            if (value >= 0)
+                ret = profile(value);
+        }
+        break;
+
+    case MS794::EventMacro:
+        if (argList.size() == 2)
+        {
+            auto index = parseNumber(argList[0], MS794::MaxMacroNum);
+            auto mode = findValue(repeatModes, argList[1]);
+            if (index > 0 && mode > 0)
+                ret = macro(index, mode);
+        }
+        break;
+
+    case MS794::EventSequence:
+        if (argList.size() >= 3 && argList[0].endsWith('x', Qt::CaseInsensitive)
+            && argList[1].endsWith("ms", Qt::CaseInsensitive))
+        {
+            auto count = parseNumber(argList[0].left(argList[0].length() - 1), 0xFF);
+            auto delay = parseNumber(argList[1].left(argList[1].length() - 2), 0xFF);
+            auto code = keyCode(argList.mid(2).join(' '));
+            if (count > 0 && delay >= 0 && code > 0)
+                ret = sequence(code, delay, count);
+        }
+        break;
+
+    case MS794::EventTripleClick:
+        if (args.isEmpty())
+            ret = tripleClick();
+        break;
+
+    case MS794::EventDisabled:
+        if (args.isEmpty())
+            ret = disabled();
+        break;
+
+    case MS794::EventCustom:
+    {
+        bool valid = false;
+        auto value = args.toUInt(&valid, 0);
+        if (valid)
+        {
+            if (ok)
+                *ok = true;
+
+            return ButtonBinding(value & ~0x0Fu);
+        }
+        break;
+    }
+    }
+
+    if (ok)
+        *ok = ret.value() != 0;
+
+    return ret;
+}
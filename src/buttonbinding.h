@@ -0,0 +1,210 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef BUTTONBINDING_H
+#define BUTTONBINDING_H
+
+#include "ms794.h"
+
+// The 32-bit button binding as stored in the device:
+//
+//   arg3 << 24 | arg2 << 16 | arg1 << 8 | event | button index
+//
+// Key:          arg1 = modifiers, arg2 = 1st key, arg3 = 2nd key
+// Button:       arg1 = mouse button
+// Profile:      arg1 = profile change (| DPI index for the lock)
+// Macro:        arg1 = macro index << 4 | repeat mode
+// Sequence:     arg1 = key, arg2 = delay, arg3 = count
+// Disabled:     arg1 = 1
+class ButtonBinding
+{
+public:
+    enum Modifier
+    {
+        LeftCtrl = 0x01,
+        LeftShift = 0x02,
+        LeftAlt = 0x04,
+        LeftSuper = 0x08,
+        RightCtrl = 0x10,
+        RightShift = 0x20,
+        RightAlt = 0x40,
+        RightSuper = 0x80,
+    };
+
+    enum Constants
+    {
+        NumModifiers = 8,
+        MaxDpiLock = MS794::MaxDpi,
+    };
+
+    constexpr explicit ButtonBinding(quint32 raw = 0)
+        : raw(raw)
+    {
+    }
+
+    //
+    // Typed constructors
+    //
+    static constexpr ButtonBinding key(int modifiers, int key1, int key2 = 0)
+    {
+        return make(MS794::EventKey, modifiers, key1, key2);
+    }
+
+    static constexpr ButtonBinding button(int mouseButton)
+    {
+        return make(MS794::EventButton, mouseButton);
+    }
+
+    static constexpr ButtonBinding profile(int change)
+    {
+        return make(MS794::EventProfile, change);
+    }
+
+    static constexpr ButtonBinding dpiLock(int dpiIndex)
+    {
+        return make(MS794::EventProfile, MS794::LockToProfile | dpiIndex);
+    }
+
+    static constexpr ButtonBinding macro(int index, int repeatMode)
+    {
+        return make(MS794::EventMacro, (0x0F & index) << 4 | (0x0F & repeatMode));
+    }
+
+    static constexpr ButtonBinding sequence(int key, int delay, int count)
+    {
+        return make(MS794::EventSequence, key, delay, count);
+    }
+
+    static constexpr ButtonBinding tripleClick()
+    {
+        return make(MS794::EventTripleClick);
+    }
+
+    static constexpr ButtonBinding disabled()
+    {
+        return make(MS794::EventDisabled, 1);
+    }
+
+    //
+    // Raw access
+    //
+    constexpr quint32 value() const
+    {
+        return raw;
+    }
+
+    constexpr int event() const
+    {
+        return 0xF0 & raw;
+    }
+
+    constexpr int index() const
+    {
+        return 0x0F & raw;
+    }
+
+    constexpr ButtonBinding withIndex(int index) const
+    {
+        return ButtonBinding((raw & ~0x0Fu) | (0x0F & index));
+    }
+
+    constexpr int arg1() const
+    {
+        return 0xFF & (raw >> 8);
+    }
+
+    constexpr int arg2() const
+    {
+        return 0xFF & (raw >> 16);
+    }
+
+    constexpr int arg3() const
+    {
+        return 0xFF & (raw >> 24);
+    }
+
+    //
+    // Typed access, valid for the corresponding event only
+    //
+    constexpr int modifiers() const
+    {
+        return arg1();
+    }
+
+    constexpr int key1() const
+    {
+        return event() == MS794::EventSequence ? arg1() : arg2();
+    }
+
+    constexpr int key2() const
+    {
+        return arg3();
+    }
+
+    constexpr int mouseButton() const
+    {
+        return arg1();
+    }
+
+    constexpr int profileChange() const
+    {
+        return arg1();
+    }
+
+    constexpr int macroIndex() const
+    {
+        return arg1() >> 4;
+    }
+
+    constexpr int repeatMode() const
+    {
+        return 0x0F & arg1();
+    }
+
+    constexpr int sequenceDelay() const
+    {
+        return arg2();
+    }
+
+    constexpr int sequenceCount() const
+    {
+        return arg3();
+    }
+
+    bool isValid() const;
+
+    // Formats the binding as text, i.e. "key LCtrl+C" or "macro 3 until-released".
+    // The button index is not included.
+    QString toString() const;
+
+    // Parses the text produced by toString(). Returns an invalid (zero) binding on error.
+    static ButtonBinding fromString(const QString &text, bool *ok = nullptr);
+
+    static const char *modifierName(int bit);
+
+private:
+    static constexpr ButtonBinding make(int event, int arg1 = 0, int arg2 = 0, int arg3 = 0)
+    {
+        return ButtonBinding(quint32(0xFF & arg3) << 24 | quint32(0xFF & arg2) << 16 | quint32(0xFF & arg1) << 8
+            | quint32(0xF0 & event));
+    }
+
+    quint32 raw;
+};
+
+#endif // BUTTONBINDING_H
@@ -17,6 +17,7 @@
  */
 
 #include "buttonedit.h"
+#include "buttonbinding.h"
 #include "usbscancodeedit.h"
 #include "mousebuttonbox.h"
 #include "ms794.h"
@@ -31,8 +32,9 @@
 #include <QSpinBox>
 #include <QxtCheckComboBox>
 
-ButtonEdit::ButtonEdit(QString labelText, QWidget *parent)
-    : QWidget(parent)
+ButtonEdit::ButtonEdit(QString labelText, int button, QWidget *parent)
+    : MiceWidget(parent)
+    , button(button)
     , buttonIndex(-1)
 {
     auto layout = new QHBoxLayout;
@@ -60,14 +62,10 @@ ButtonEdit::ButtonEdit(QString labelText, QWidget *parent)
     // Keyboard key or combo
     //
     cbModifiers = new QxtCheckComboBox;
-    cbModifiers->addItem(tr("LCtrl"), 0x01);
-    cbModifiers->addItem(tr("LShift"), 0x02);
-    cbModifiers->addItem(tr("LAlt"), 0x04);
-    cbModifiers->addItem(tr("LSuper"), 0x08);
-    cbModifiers->addItem(tr("RCtrl"), 0x10);
-    cbModifiers->addItem(tr("RShift"), 0x20);
-    cbModifiers->addItem(tr("RAlt"), 0x40);
-    cbModifiers->addItem(tr("RSuper"), 0x80);
+    for (int bit = 0; bit < ButtonBinding::NumModifiers; ++bit)
+    {
+        cbModifiers->addItem(tr(ButtonBinding::modifierName(bit)), 1 << bit);
+    }
     cbModifiers->setDefaultText(tr("None"));
     cbModifiers->setMinimumWidth(measuredWidth * 2);
     layout->addWidget(cbModifiers);
@@ -140,20 +138,54 @@ ButtonEdit::ButtonEdit(QString labelText, QWidget *parent)
     layout->addWidget(editCustom);
     layout->addStretch();
     setLayout(layout);
+
+    // Only the widgets of the current mode are visible
+    QWidget *modeWidgets[] = {cbModifiers, editScans[0], editScans[1], cbButton, spinCount, spinDelay, cbProfile,
+        spinMacroIndex, labelRepeat, cbRepeatMode, editCustom};
+    for (auto widget : modeWidgets)
+    {
+        widget->hide();
+    }
+
+    connect(cbMode, SIGNAL(currentIndexChanged(int)), this, SLOT(markModified()));
+    connect(cbModifiers, SIGNAL(checkedItemsChanged(QStringList)), this, SLOT(markModified()));
+    connect(editScans[0], SIGNAL(textChanged(QString)), this, SLOT(markModified()));
+    connect(editScans[1], SIGNAL(textChanged(QString)), this, SLOT(markModified()));
+    connect(cbButton, SIGNAL(currentIndexChanged(int)), this, SLOT(markModified()));
+    connect(spinCount, SIGNAL(valueChanged(int)), this, SLOT(markModified()));
+    connect(spinDelay, SIGNAL(valueChanged(int)), this, SLOT(markModified()));
+    connect(cbProfile, SIGNAL(currentIndexChanged(int)), this, SLOT(markModified()));
+    connect(spinMacroIndex, SIGNAL(valueChanged(int)), this, SLOT(markModified()));
+    connect(cbRepeatMode, SIGNAL(currentIndexChanged(int)), this, SLOT(markModified()));
+    connect(editCustom, SIGNAL(textChanged(QString)), this, SLOT(markModified()));
+}
+
+bool ButtonEdit::load(MS794 *mice)
+{
+    auto value = mice->button(MS794::ButtonIndex(button));
+    if (value == -1)
+        return false;
+
+    setValue(value);
+    setModified(false);
+    return true;
+}
+
+void ButtonEdit::save(MS794 *mice)
+{
+    mice->setButton(MS794::ButtonIndex(button), value());
 }
 
 void ButtonEdit::setValue(quint32 value)
 {
-    buttonIndex = 0x0F & value;
-    quint8 mode = 0xF0 & value;
-    quint8 arg1 = 0xFF & (value >> 8);
-    quint8 arg2 = 0xFF & (value >> 16);
-    quint8 arg3 = 0xFF & (value >> 24);
+    ButtonBinding binding(value);
+    buttonIndex = binding.index();
+    int mode = binding.event();
     setUpdatesEnabled(false);
     editCustom->setText(QString("%1 %2 %3 %4")
-                            .arg(arg3, 2, 16, QChar('0'))
-                            .arg(arg2, 2, 16, QChar('0'))
-                            .arg(arg1, 2, 16, QChar('0'))
+                            .arg(binding.arg3(), 2, 16, QChar('0'))
+                            .arg(binding.arg2(), 2, 16, QChar('0'))
+                            .arg(binding.arg1(), 2, 16, QChar('0'))
                             .arg(mode, 2, 16, QChar('0')));
 
     // Hide everything, will show some ot them later
@@ -162,42 +194,42 @@ void ButtonEdit::setValue(quint32 value)
     switch (mode)
     {
     case MS794::EventButton:
-        cbButton->setValue(arg1);
-        cbButton->setVisible(true);
+        cbButton->setValue(binding.mouseButton());
+        showWidget(cbButton);
         break;
 
     case MS794::EventSequence:
-        editScans[0]->setValue(arg1);
-        editScans[0]->setVisible(true);
-        spinCount->setValue(arg3);
-        spinCount->setVisible(true);
-        spinDelay->setValue(arg2);
-        spinDelay->setVisible(true);
+        editScans[0]->setValue(binding.key1());
+        showWidget(editScans[0]);
+        spinCount->setValue(binding.sequenceCount());
+        showWidget(spinCount);
+        spinDelay->setValue(binding.sequenceDelay());
+        showWidget(spinDelay);
         break;
 
     case MS794::EventTripleClick:
         break;
 
     case MS794::EventKey:
-        cbModifiers->setMask(arg1);
-        cbModifiers->setVisible(true);
-        editScans[0]->setValue(arg2);
-        editScans[0]->setVisible(true);
-        editScans[1]->setValue(arg3);
-        editScans[1]->setVisible(true);
+        cbModifiers->setMask(binding.modifiers());
+        showWidget(cbModifiers);
+        editScans[0]->setValue(binding.key1());
+        showWidget(editScans[0]);
+        editScans[1]->setValue(binding.key2());
+        showWidget(editScans[1]);
         break;
 
     case MS794::EventProfile:
-        cbProfile->setCurrentIndex(cbProfile->findData(arg1));
-        cbProfile->setVisible(true);
+        cbProfile->setCurrentIndex(cbProfile->findData(binding.profileChange()));
+        showWidget(cbProfile);
         break;
 
     case MS794::EventMacro:
-        spinMacroIndex->setValue(arg1 >> 4);
-        spinMacroIndex->setVisible(true);
-        labelRepeat->setVisible(true);
-        cbRepeatMode->setCurrentIndex(cbRepeatMode->findData(arg1 & 0x0F));
-        cbRepeatMode->setVisible(true);
+        spinMacroIndex->setValue(binding.macroIndex());
+        showWidget(spinMacroIndex);
+        showWidget(labelRepeat);
+        cbRepeatMode->setCurrentIndex(cbRepeatMode->findData(binding.repeatMode()));
+        showWidget(cbRepeatMode);
         break;
 
     case MS794::EventDisabled:
@@ -206,7 +238,7 @@ void ButtonEdit::setValue(quint32 value)
 
     default:
         mode = MS794::EventCustom;
-        editCustom->setVisible(true);
+        showWidget(editCustom);
         break;
     }
 
@@ -228,51 +260,48 @@ int ButtonEdit::index() const
 
 quint32 ButtonEdit::extractValue(quint32 mode) const
 {
-    quint8 arg1 = 0, arg2 = 0, arg3 = 0;
+    ButtonBinding binding;
 
     switch (mode)
     {
     case MS794::EventKey:
-        arg1 = 0xFF & cbModifiers->mask();
-        arg2 = 0xFF & editScans[0]->value();
-        arg3 = 0xFF & editScans[1]->value();
+        binding = ButtonBinding::key(cbModifiers->mask(), editScans[0]->value(), editScans[1]->value());
         break;
 
     case MS794::EventButton:
-        arg1 = 0xFF & cbButton->value();
+        binding = ButtonBinding::button(cbButton->value());
         break;
 
     case MS794::EventTripleClick:
+        binding = ButtonBinding::tripleClick();
         break;
 
     case MS794::EventProfile:
-        arg1 = 0xFF & cbProfile->currentData().toUInt();
+        binding = ButtonBinding::profile(cbProfile->currentData().toInt());
         break;
 
     case MS794::EventMacro:
-        arg1 = ((0x0F & spinMacroIndex->value()) << 4)
-             | (0xF & cbRepeatMode->currentData().toUInt());
+        binding = ButtonBinding::macro(spinMacroIndex->value(), cbRepeatMode->currentData().toInt());
         break;
 
     case MS794::EventSequence:
-        arg1 = 0xFF & editScans[0]->value();
-        arg3 = 0xFF & spinCount->value();
-        arg2 = 0xFF & spinDelay->value();
+        binding = ButtonBinding::sequence(editScans[0]->value(), spinDelay->value(), spinCount->value());
         break;
 
     case MS794::EventDisabled:
-        arg1 = 1;
+        binding = ButtonBinding::disabled();
         break;
 
     case MS794::EventCustom:
-        return editCustom->text().replace(" ", "").toUInt(nullptr, 16) | buttonIndex;
+        binding = ButtonBinding(editCustom->text().replace(" ", "").toUInt(nullptr, 16));
+        break;
 
     default:
         Q_ASSERT(!"Unhandled mode");
         break;
     }
 
-    return (arg3 << 24) | (arg2 << 16) | (arg1 << 8) | mode | buttonIndex;
+    return binding.withIndex(buttonIndex).value();
 }
 
 void ButtonEdit::onModeChanged(int idx)
@@ -291,7 +320,7 @@ void ButtonEdit::onModeChanged(int idx)
                                 .arg(0xFF & value >> 16, 2, 16, QChar('0'))
                                 .arg(0xFF & value >> 8, 2, 16, QChar('0'))
                                 .arg(oldMode, 2, 16, QChar('0')));
-        editCustom->show();
+        showWidget(editCustom);
     }
     else
     {
@@ -303,11 +332,16 @@ void ButtonEdit::onModeChanged(int idx)
 
 void ButtonEdit::hideWidgets()
 {
-    foreach (auto widget, findChildren<QWidget *>(QString(), Qt::FindDirectChildrenOnly))
+    foreach (auto widget, visibleWidgets)
     {
-        if (widget == label || widget == cbMode)
-            continue;
-
         widget->hide();
     }
+
+    visibleWidgets.clear();
+}
+
+void ButtonEdit::showWidget(QWidget *widget)
+{
+    widget->show();
+    visibleWidgets.push_back(widget);
 }
@@ -19,14 +19,14 @@
 #ifndef BUTTONEDIT_H
 #define BUTTONEDIT_H
 
-#include <QWidget>
+#include "micewidget.h"
 
 QT_FORWARD_DECLARE_CLASS(QComboBox)
 QT_FORWARD_DECLARE_CLASS(QLineEdit)
 QT_FORWARD_DECLARE_CLASS(QLabel)
 QT_FORWARD_DECLARE_CLASS(QSpinBox)
 
-class ButtonEdit : public QWidget
+class ButtonEdit : public MiceWidget
 {
     Q_PROPERTY(quint32 value READ value WRITE setValue)
     Q_PROPERTY(int index READ index)
@@ -34,7 +34,10 @@ class ButtonEdit : public QWidget
     Q_OBJECT
 
 public:
-    explicit ButtonEdit(QString labelText, QWidget *parent = 0);
+    explicit ButtonEdit(QString labelText, int button, QWidget *parent = 0);
+
+    bool load(class MS794 *mice);
+    void save(class MS794 *mice);
 
     quint32 value() const;
     void setValue(quint32 value);
@@ -47,8 +50,13 @@ public slots:
 private:
     quint32 extractValue(quint32 mode) const;
     void hideWidgets();
+    void showWidget(QWidget *widget);
 
+    // MS794::ButtonIndex
+    int button;
+    // The low nibble of the value
     int buttonIndex;
+    std::vector<QWidget *> visibleWidgets;
 
     QLabel *label;
     QComboBox *cbMode;
@@ -17,6 +17,7 @@
  */
 
 #include "colorbutton.h"
+#include "colorswatch.h"
 
 #include <QColorDialog>
 
@@ -34,10 +35,12 @@ int ColorButton::value() const
 
 void ColorButton::setValue(int value)
 {
-    QPixmap px(128, 128);
-    px.fill(QColor(value));
-    setIcon(px);
+    if (color == value)
+        return;
+
+    setIcon(ColorSwatch::pixmap(value, iconSize()));
     color = value;
+    emit valueChanged(value);
 }
 
 void ColorButton::click()
@@ -33,6 +33,9 @@ public:
     int value() const;
     void setValue(int value);
 
+signals:
+    void valueChanged(int value);
+
 public slots:
     void click();
 
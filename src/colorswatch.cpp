@@ -0,0 +1,43 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "colorswatch.h"
+
+#include <QApplication>
+#include <QPixmapCache>
+
+QPixmap ColorSwatch::pixmap(int color, const QSize &size)
+{
+    auto ratio = qApp->devicePixelRatio();
+    auto key = QString("swatch-%1-%2x%3@%4")
+                   .arg(color & 0xFFFFFF, 6, 16, QChar('0'))
+                   .arg(size.width())
+                   .arg(size.height())
+                   .arg(ratio);
+    QPixmap px;
+
+    if (!QPixmapCache::find(key, &px))
+    {
+        px = QPixmap(size * ratio);
+        px.setDevicePixelRatio(ratio);
+        px.fill(QColor(QRgb(color)));
+        QPixmapCache::insert(key, px);
+    }
+
+    return px;
+}
@@ -0,0 +1,32 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef COLORSWATCH_H
+#define COLORSWATCH_H
+
+#include <QPixmap>
+
+// Solid color pixmaps for the icons, shared by the whole application through QPixmapCache.
+class ColorSwatch
+{
+public:
+    // The color is 0xRRGGBB, the size is the one the icon is displayed at.
+    static QPixmap pixmap(int color, const QSize &size);
+};
+
+#endif // COLORSWATCH_H
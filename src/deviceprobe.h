@@ -0,0 +1,47 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef DEVICEPROBE_H
+#define DEVICEPROBE_H
+
+#include <QThread>
+
+// Opens the device and reads all the pages into the cache off the GUI thread.
+// Nobody else may use the device until the probe has finished, so defer the arrivals
+// with MS794::setArrivalsDeferred() for that time.
+class DeviceProbe : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit DeviceProbe(class MS794 *mice, QObject *parent = 0);
+
+    // Valid once finished
+    bool isConnected() const;
+    int duration() const;
+
+protected:
+    void run();
+
+private:
+    class MS794 *mice;
+    bool connected;
+    int durationValue;
+};
+
+#endif // DEVICEPROBE_H
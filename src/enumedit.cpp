@@ -25,7 +25,8 @@
 #include <QStyle>
 #include <QValidator>
 
-EnumEdit::EnumEdit(const std::vector<Item> &items, const std::vector<Item> &groups, QWidget *parent)
+EnumEdit::EnumEdit(const std::vector<Item> &items, const std::vector<Item> &groups,
+    QAbstractItemModel *completionModel, QWidget *parent)
     : QLineEdit(parent)
     , menu(nullptr)
     , items(items)
@@ -35,15 +36,7 @@ EnumEdit::EnumEdit(const std::vector<Item> &items, const std::vector<Item> &grou
     addAction(chooseAction, LeadingPosition);
     connect(chooseAction, SIGNAL(triggered()), this, SLOT(onDropDownAction()));
 
-    // Init completer
-    QStringList strList;
-    foreach (auto item, items)
-    {
-        if (*item.name)
-            strList << item.name;
-    }
-
-    auto completer = new QCompleter(strList, this);
+    auto completer = new QCompleter(completionModel, this);
     completer->setCaseSensitivity(Qt::CaseInsensitive);
     completer->setFilterMode(Qt::MatchContains);
     setCompleter(completer);
@@ -74,16 +67,21 @@ int EnumEdit::value() const
     if (name.isEmpty())
         return 0;
 
-    auto lambda = [name](const Item &i) { return name.compare(tr(i.name), Qt::CaseInsensitive) == 0; };
-    auto item = std::find_if(items.cbegin(), items.cend(), lambda);
-
-    if (item != items.cend())
-        return item - items.cbegin();
+    auto item = findItem(name);
+    if (item >= 0)
+        return item;
 
     // Not found by name, treat as a hex sequence.
     return name.replace(" ", "").toInt(nullptr, 16);
 }
 
+int EnumEdit::findItem(const QString &name) const
+{
+    auto lambda = [name](const Item &i) { return name.compare(i.name, Qt::CaseInsensitive) == 0; };
+    auto item = std::find_if(items.cbegin(), items.cend(), lambda);
+    return item != items.cend() ? int(item - items.cbegin()) : -1;
+}
+
 void EnumEdit::onDropDownAction()
 {
     // If the menu is not created already, fill it with groups. Items will be added later.
@@ -21,6 +21,7 @@
 
 #include <QLineEdit>
 
+QT_FORWARD_DECLARE_CLASS(QAbstractItemModel)
 QT_FORWARD_DECLARE_CLASS(QMenu)
 
 class EnumEdit : public QLineEdit
@@ -35,11 +36,17 @@ public:
         int group;
     };
 
-    explicit EnumEdit(const std::vector<Item> &items, const std::vector<Item> &groups, QWidget *parent = 0);
+    // The items, the groups and the completion model are shared by all the editors and must outlive them.
+    explicit EnumEdit(const std::vector<Item> &items, const std::vector<Item> &groups,
+        QAbstractItemModel *completionModel, QWidget *parent = 0);
 
     int value() const;
     void setValue(const int value);
 
+protected:
+    // Returns -1 for unknown names.
+    virtual int findItem(const QString &name) const;
+
 private slots:
     void onDropDownAction();
     void prepareSubMenu();
@@ -47,8 +54,8 @@ private slots:
 private:
     QMenu *menu;
 
-    std::vector<Item> items;
-    std::vector<Item> groups;
+    const std::vector<Item> &items;
+    const std::vector<Item> &groups;
 };
 
 #endif // ENUMEDIT_H
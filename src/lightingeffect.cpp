@@ -0,0 +1,224 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "lightingeffect.h"
+
+#include <QColor>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+
+#include <math.h>
+
+// Slow sources are polled at most that often, msec
+#define CPU_POLL_INTERVAL 500
+#define STATUS_POLL_INTERVAL 1000
+#define PULSE_PERIOD 2000
+
+// 0 => dark, 1 => full brightness
+static int scaleColor(int rgb, double factor)
+{
+    return QColor(rgb).darker(factor > 0.01 ? int(100 / factor) : 10000).rgb() & 0xFFFFFF;
+}
+
+static double pulse(qint64 time, int period)
+{
+    return (1 - cos(2 * LightingEffect::Pi * (time % period) / period)) / 2;
+}
+
+class RainbowEffect : public LightingEffect
+{
+public:
+    void render(qint64 time, int *colors, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            colors[i] = QColor::fromHsv(int(time / 20 + i * 360 / count) % 360, 255, 255).rgb() & 0xFFFFFF;
+        }
+    }
+};
+
+class PulseEffect : public LightingEffect
+{
+public:
+    explicit PulseEffect(int color)
+        : color(color)
+    {
+    }
+
+    void render(qint64 time, int *colors, int count)
+    {
+        auto value = scaleColor(color, pulse(time, PULSE_PERIOD));
+        for (int i = 0; i < count; ++i)
+        {
+            colors[i] = value;
+        }
+    }
+
+private:
+    int color;
+};
+
+// Green when idle, yellow at half load, red when busy. Linux only, black elsewhere.
+class CpuLoadEffect : public LightingEffect
+{
+public:
+    CpuLoadEffect()
+        : lastPoll(-CPU_POLL_INTERVAL)
+        , lastBusy(0)
+        , lastTotal(0)
+        , load(0)
+    {
+    }
+
+    void render(qint64 time, int *colors, int count)
+    {
+        if (time - lastPoll >= CPU_POLL_INTERVAL)
+        {
+            lastPoll = time;
+            poll();
+        }
+
+        auto value = QColor::fromHsv(int(120 * (1 - load)), 255, 255).rgb() & 0xFFFFFF;
+        for (int i = 0; i < count; ++i)
+        {
+            colors[i] = value;
+        }
+    }
+
+private:
+    void poll()
+    {
+        QFile file("/proc/stat");
+        if (!file.open(QFile::ReadOnly))
+            return;
+
+        // cpu user nice system idle iowait irq softirq ...
+        auto fields = QString(file.readLine()).simplified().split(' ');
+        qint64 total = 0, idle = 0;
+        for (int i = 1; i < fields.size(); ++i)
+        {
+            total += fields[i].toLongLong();
+            if (i == 4 || i == 5)
+                idle += fields[i].toLongLong();
+        }
+
+        auto busy = total - idle;
+        if (lastTotal > 0 && total > lastTotal)
+            load = double(busy - lastBusy) / (total - lastTotal);
+
+        lastBusy = busy;
+        lastTotal = total;
+    }
+
+    qint64 lastPoll;
+    qint64 lastBusy;
+    qint64 lastTotal;
+    double load;
+};
+
+// Follows a status file written by a build script or CI poller:
+// "ok"/"pass"/"success" => green, "fail"/"error" => red, "running"/"pending" => pulsing yellow.
+class StatusEffect : public LightingEffect
+{
+public:
+    explicit StatusEffect(const QString &path)
+        : path(path)
+        , lastPoll(-STATUS_POLL_INTERVAL)
+        , color(0)
+        , pulsing(false)
+    {
+    }
+
+    void render(qint64 time, int *colors, int count)
+    {
+        if (time - lastPoll >= STATUS_POLL_INTERVAL)
+        {
+            lastPoll = time;
+            poll();
+        }
+
+        auto value = pulsing ? scaleColor(color, pulse(time, PULSE_PERIOD)) : color;
+        for (int i = 0; i < count; ++i)
+        {
+            colors[i] = value;
+        }
+    }
+
+private:
+    void poll()
+    {
+        QFileInfo info(path);
+        if (info.lastModified() == modified)
+            return;
+
+        modified = info.lastModified();
+        QFile file(path);
+        auto status = file.open(QFile::ReadOnly) ? QString(file.readLine()).trimmed().toLower() : QString();
+
+        pulsing = false;
+        if (status == "ok" || status == "pass" || status == "success")
+        {
+            color = 0x00FF00;
+        }
+        else if (status == "fail" || status == "error")
+        {
+            color = 0xFF0000;
+        }
+        else if (status == "running" || status == "pending")
+        {
+            color = 0xFFFF00;
+            pulsing = true;
+        }
+        else
+        {
+            color = 0;
+        }
+    }
+
+    QString path;
+    QDateTime modified;
+    qint64 lastPoll;
+    int color;
+    bool pulsing;
+};
+
+LightingEffect *LightingEffect::create(const QString &name, const QString &arg)
+{
+    if (name == "rainbow")
+        return new RainbowEffect;
+
+    if (name == "pulse")
+    {
+        QColor color(arg.isEmpty() ? QString("#0000ff") : arg);
+        return color.isValid() ? new PulseEffect(color.rgb() & 0xFFFFFF) : nullptr;
+    }
+
+    if (name == "cpu")
+        return new CpuLoadEffect;
+
+    if (name == "status")
+        return arg.isEmpty() ? nullptr : new StatusEffect(arg);
+
+    return nullptr;
+}
+
+QStringList LightingEffect::names()
+{
+    return QStringList() << "rainbow" << "pulse" << "cpu" << "status";
+}
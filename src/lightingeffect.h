@@ -0,0 +1,43 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LIGHTINGEFFECT_H
+#define LIGHTINGEFFECT_H
+
+#include <QStringList>
+
+// A host computed lighting effect.
+class LightingEffect
+{
+public:
+    // M_PI is not standard C++, MSVC lacks it without _USE_MATH_DEFINES
+    static constexpr double Pi = 3.14159265358979323846;
+
+    virtual ~LightingEffect()
+    {
+    }
+
+    // Fills the colors (0xRRGGBB) for the given time since the start, msec.
+    virtual void render(qint64 time, int *colors, int count) = 0;
+
+    // The argument is effect specific: a color for "pulse", a file for "status".
+    static LightingEffect *create(const QString &name, const QString &arg = QString());
+    static QStringList names();
+};
+
+#endif // LIGHTINGEFFECT_H
@@ -0,0 +1,216 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "lightingengine.h"
+#include "lightingeffect.h"
+#include "ms794.h"
+
+#include <QDebug>
+#include <QTimer>
+
+// The steady mode shows the first color only
+#define NUM_COLORS 1
+#define MAX_BRIGHTNESS 10
+
+LightingEngine::LightingEngine(MS794 *mice, QObject *parent)
+    : QObject(parent)
+    , mice(mice)
+    , effect(nullptr)
+    , timer(new QTimer(this))
+    , frameInterval(1000 / DefaultFps)
+    , lastFrame(-1)
+    , lastColor(-1)
+    , savedType(-1)
+    , savedValue(-1)
+    , savedColor(-1)
+    , rendered(0)
+    , written(0)
+    , unchanged(0)
+    , skipped(0)
+    , writeTime(0)
+    , maxWriteTime(0)
+    , runTime(0)
+{
+    timer->setSingleShot(true);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, SIGNAL(timeout()), this, SLOT(onTimeout()));
+}
+
+LightingEngine::~LightingEngine()
+{
+    stop();
+    delete effect;
+}
+
+void LightingEngine::setEffect(LightingEffect *value)
+{
+    delete effect;
+    effect = value;
+    lastColor = -1;
+}
+
+void LightingEngine::setMaxFps(int fps)
+{
+    frameInterval = 1000 / qBound(1, fps, int(MaxFps));
+}
+
+bool LightingEngine::start()
+{
+    stop();
+
+    if (!effect)
+        return false;
+
+    rendered = written = unchanged = skipped = 0;
+    writeTime = maxWriteTime = runTime = 0;
+    lastFrame = -1;
+    lastColor = -1;
+
+    savedType = mice->lightType();
+    savedValue = mice->lightValue();
+    savedColor = mice->lightColor(0);
+    if (savedType < 0 || savedValue < 0 || savedColor < 0)
+        return false;
+
+    mice->setLightType(MS794::LightSteady << 4 | MAX_BRIGHTNESS);
+    mice->setLightValue(NUM_COLORS);
+
+    clock.start();
+    timer->start(0);
+    return true;
+}
+
+void LightingEngine::stop()
+{
+    if (!clock.isValid())
+        return;
+
+    timer->stop();
+    runTime = clock.elapsed();
+    clock.invalidate();
+
+    if (savedType >= 0)
+    {
+        mice->setLightType(savedType);
+        mice->setLightValue(savedValue);
+        mice->setLightColor(0, savedColor);
+        if (!mice->save(MS794::PageLighting))
+            qWarning() << "Lighting: failed to restore the device state";
+
+        savedType = -1;
+    }
+}
+
+bool LightingEngine::isRunning() const
+{
+    return clock.isValid();
+}
+
+void LightingEngine::onTimeout()
+{
+    auto now = clock.elapsed();
+    auto frame = now / frameInterval;
+
+    if (lastFrame >= 0 && frame > lastFrame + 1)
+    {
+        // The device (or the effect) was too slow, never catch up.
+        skipped += int(frame - lastFrame - 1);
+    }
+    lastFrame = frame;
+
+    int colors[NUM_COLORS];
+    effect->render(now, colors, NUM_COLORS);
+    ++rendered;
+
+    if (colors[0] == lastColor)
+    {
+        ++unchanged;
+    }
+    else if (!write(colors))
+    {
+        qWarning() << "Lighting: failed to write to the device";
+        stop();
+        emit failed();
+        return;
+    }
+
+    // The next frame boundary, which may be already passed.
+    timer->start(int(qMax(qint64(0), (frame + 1) * frameInterval - clock.elapsed())));
+}
+
+bool LightingEngine::write(const int *colors)
+{
+    QElapsedTimer duration;
+    duration.start();
+
+    mice->setLightColor(0, colors[0]);
+    if (!mice->save(MS794::PageLighting))
+        return false;
+
+    auto elapsed = duration.elapsed();
+    writeTime += elapsed;
+    maxWriteTime = qMax(maxWriteTime, elapsed);
+    lastColor = colors[0];
+    ++written;
+    return true;
+}
+
+int LightingEngine::renderedFrames() const
+{
+    return rendered;
+}
+
+int LightingEngine::writtenFrames() const
+{
+    return written;
+}
+
+int LightingEngine::unchangedFrames() const
+{
+    return unchanged;
+}
+
+int LightingEngine::skippedFrames() const
+{
+    return skipped;
+}
+
+double LightingEngine::achievedFps() const
+{
+    auto elapsed = clock.isValid() ? clock.elapsed() : runTime;
+    return elapsed > 0 ? written * 1000.0 / elapsed : 0;
+}
+
+double LightingEngine::meanWriteTime() const
+{
+    return written ? double(writeTime) / written : 0;
+}
+
+QJsonObject LightingEngine::toJson() const
+{
+    QJsonObject json;
+    json["max_fps"] = 1000 / frameInterval;
+    json["rendered"] = rendered;
+    json["written"] = written;
+    json["unchanged"] = unchanged;
+    json["skipped"] = skipped;
+    json["write_fps"] = achievedFps();
+    json["write_ms_mean"] = meanWriteTime();
+    json["write_ms_max"] = double(maxWriteTime);
+    return json;
+}
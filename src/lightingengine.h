@@ -0,0 +1,92 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LIGHTINGENGINE_H
+#define LIGHTINGENGINE_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QObject>
+
+// Streams the frames of a host computed effect to the device by rewriting the steady light color.
+// The frames are bound to the wall clock: when the device falls behind, the late frames are skipped
+// instead of being queued, and a frame is written only if its colors differ from the previous one.
+class LightingEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Constants
+    {
+        DefaultFps = 30,
+        MaxFps = 100,
+    };
+
+    explicit LightingEngine(class MS794 *mice, QObject *parent = 0);
+    ~LightingEngine();
+
+    // Takes the ownership of the effect.
+    void setEffect(class LightingEffect *effect);
+    void setMaxFps(int fps);
+
+    bool start();
+    void stop();
+    bool isRunning() const;
+
+    int renderedFrames() const;
+    int writtenFrames() const;
+    int unchangedFrames() const;
+    int skippedFrames() const;
+    // Writes per second since the start
+    double achievedFps() const;
+    double meanWriteTime() const;
+
+    QJsonObject toJson() const;
+
+signals:
+    void failed();
+
+private slots:
+    void onTimeout();
+
+private:
+    bool write(const int *colors);
+
+    class MS794 *mice;
+    class LightingEffect *effect;
+    class QTimer *timer;
+    QElapsedTimer clock;
+    int frameInterval;
+    qint64 lastFrame;
+    int lastColor;
+
+    // The device state to restore on stop
+    int savedType;
+    int savedValue;
+    int savedColor;
+
+    int rendered;
+    int written;
+    int unchanged;
+    int skipped;
+    qint64 writeTime;
+    qint64 maxWriteTime;
+    qint64 runTime;
+};
+
+#endif // LIGHTINGENGINE_H
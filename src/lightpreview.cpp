@@ -0,0 +1,220 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "lightpreview.h"
+#include "lightingeffect.h"
+
+#include <QPainter>
+#include <QTimerEvent>
+
+#include <math.h>
+
+// Precomputed once, so rendering a frame is integer math only.
+struct Tables
+{
+    // The color wheel, 256 steps
+    QRgb hue[256];
+    // (1 - cos) / 2 over a period of 256 steps, 0..255
+    int wave[256];
+
+    Tables()
+    {
+        for (int i = 0; i < 256; ++i)
+        {
+            hue[i] = QColor::fromHsv(i * 360 / 256, 255, 255).rgb();
+            wave[i] = qRound(255 * (1 - cos(2 * LightingEffect::Pi * i / 256)) / 2);
+        }
+    }
+};
+
+static const Tables &tables()
+{
+    static Tables instance;
+    return instance;
+}
+
+// level is 0..255
+static QRgb scale(QRgb color, int level)
+{
+    return qRgb(qRed(color) * level / 255, qGreen(color) * level / 255, qBlue(color) * level / 255);
+}
+
+LightPreview::LightPreview(QWidget *parent)
+    : QWidget(parent)
+    , type(MS794::LightOff)
+    , level(0)
+    , value(0)
+    , period(1000)
+    , numColors(0)
+{
+    std::fill(colors, colors + MS794::MaxLightColor, qRgb(0, 0, 0));
+    std::fill(leds, leds + NumLeds, qRgb(0, 0, 0));
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    clock.start();
+}
+
+void LightPreview::setMode(int typeValue, int lightValue, const int *colorValues, int count)
+{
+    type = typeValue >> 4;
+    level = typeValue & 0x0F;
+    value = lightValue;
+    numColors = qBound(0, count, int(MS794::MaxLightColor));
+    for (int i = 0; i < numColors; ++i)
+    {
+        colors[i] = QRgb(colorValues[i]);
+    }
+
+    // Speed 1 is the slowest one
+    period = 3000 / qBound(1, level, 3);
+
+    renderFrame(clock.elapsed());
+    updateTimer();
+    update();
+}
+
+QSize LightPreview::sizeHint() const
+{
+    return QSize(NumLeds * 16, 16);
+}
+
+bool LightPreview::isAnimated() const
+{
+    return type != MS794::LightOff && type != MS794::LightSteady && type != MS794::LightColorfulSteady;
+}
+
+void LightPreview::updateTimer()
+{
+    if (isVisible() && isAnimated())
+    {
+        if (!timer.isActive())
+            timer.start(FrameInterval, Qt::PreciseTimer, this);
+    }
+    else
+    {
+        timer.stop();
+    }
+}
+
+void LightPreview::showEvent(QShowEvent *)
+{
+    updateTimer();
+}
+
+void LightPreview::hideEvent(QHideEvent *)
+{
+    updateTimer();
+}
+
+void LightPreview::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != timer.timerId())
+    {
+        QWidget::timerEvent(event);
+        return;
+    }
+
+    renderFrame(clock.elapsed());
+    update();
+}
+
+void LightPreview::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().window());
+
+    for (int i = 0; i < NumLeds; ++i)
+    {
+        int left = i * width() / NumLeds;
+        int right = (i + 1) * width() / NumLeds;
+        painter.fillRect(left + 1, 1, right - left - 2, height() - 2, QColor(leds[i]));
+    }
+}
+
+void LightPreview::renderFrame(qint64 time)
+{
+    const auto &t = tables();
+    auto phase = int((time % period) * 256 / period);
+    auto cycle = int(time / period);
+    // Streaming "Up" has the bit set
+    auto step = value & 0x80 ? 256 / NumLeds : -256 / NumLeds;
+    auto head = phase * NumLeds / 256;
+
+    for (int i = 0; i < NumLeds; ++i)
+    {
+        QRgb color = qRgb(0, 0, 0);
+
+        switch (type)
+        {
+        case MS794::LightColorfulStreaming:
+            color = t.hue[0xFF & (phase + i * step)];
+            break;
+
+        case MS794::LightStreaming:
+            // Solid bands instead of a gradient
+            color = t.hue[(0xFF & (phase + i * step)) / 32 * 32];
+            break;
+
+        case MS794::LightSteady:
+            if (numColors > 0)
+                color = scale(colors[0], level * 255 / 10);
+            break;
+
+        case MS794::LightBreathing:
+            if (numColors > 0)
+                color = scale(colors[cycle % numColors], t.wave[phase]);
+            break;
+
+        case MS794::LightTail:
+        case MS794::LightTrailing:
+        {
+            auto distance = (head - i + NumLeds) % NumLeds;
+            auto base = type == MS794::LightTail ? t.hue[0xFF & (cycle * 40)] : t.hue[i * 256 / NumLeds];
+            color = scale(base, qMax(0, 255 - distance * 64));
+            break;
+        }
+
+        case MS794::LightNeon:
+            color = t.hue[phase];
+            break;
+
+        case MS794::LightColorfulSteady:
+            if (numColors > 0)
+                color = colors[i * numColors / NumLeds];
+            break;
+
+        case MS794::LightFliker:
+            if (numColors > 0 && (phase / 16) % 2 == 0)
+                color = colors[phase < 128 || numColors < 2 ? 0 : 1];
+            break;
+
+        case MS794::LightResponse:
+            // As if clicked once per period
+            if (value & 0x80)
+                color = scale(t.hue[0xFF & (cycle * 97)], 255 - phase);
+            else if (numColors > 0)
+                color = scale(colors[cycle % numColors], 255 - phase);
+            break;
+
+        case MS794::LightWave:
+            color = scale(t.hue[i * 256 / NumLeds], t.wave[0xFF & (phase + i * 256 / NumLeds)]);
+            break;
+        }
+
+        leds[i] = color;
+    }
+}
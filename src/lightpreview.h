@@ -0,0 +1,72 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LIGHTPREVIEW_H
+#define LIGHTPREVIEW_H
+
+#include "ms794.h"
+
+#include <QBasicTimer>
+#include <QElapsedTimer>
+#include <QWidget>
+
+// Simulates the firmware lighting modes on a strip of LEDs, so the settings can be tried
+// without writing them to the device. That is an approximation, the exact patterns are
+// up to the firmware. The animation runs only while the widget is visible.
+class LightPreview : public QWidget
+{
+    Q_OBJECT
+
+public:
+    enum Constants
+    {
+        NumLeds = 16,
+        // ~60 frames per second
+        FrameInterval = 16,
+    };
+
+    explicit LightPreview(QWidget *parent = 0);
+
+    // Same as MS794::setLightType / setLightValue, the colors are the enabled ones in order.
+    void setMode(int type, int value, const int *colors, int numColors);
+
+    QSize sizeHint() const;
+
+protected:
+    void paintEvent(QPaintEvent *);
+    void timerEvent(QTimerEvent *event);
+    void showEvent(QShowEvent *);
+    void hideEvent(QHideEvent *);
+
+private:
+    bool isAnimated() const;
+    void updateTimer();
+    void renderFrame(qint64 time);
+
+    QBasicTimer timer;
+    QElapsedTimer clock;
+    int type;
+    int level;
+    int value;
+    int period;
+    int numColors;
+    QRgb colors[MS794::MaxLightColor];
+    QRgb leds[NumLeds];
+};
+
+#endif // LIGHTPREVIEW_H
@@ -0,0 +1,131 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "liveapplier.h"
+#include "ms794.h"
+
+#include <QDebug>
+#include <QTimer>
+
+LiveApplier::LiveApplier(MS794 *mice, QObject *parent)
+    : QObject(parent)
+    , mice(mice)
+    , timer(new QTimer(this))
+    , enabled(false)
+    , windowValue(DefaultWindow)
+    , firstEdit(-1)
+    , lastWrite(0)
+    , lastDuration(0)
+    , applyCount(0)
+    , lastValue(0)
+    , sum(0)
+    , maxValue(0)
+{
+    clock.start();
+    timer->setSingleShot(true);
+    connect(timer, SIGNAL(timeout()), this, SLOT(onTimeout()));
+}
+
+bool LiveApplier::isEnabled() const
+{
+    return enabled;
+}
+
+void LiveApplier::setEnabled(bool value)
+{
+    enabled = value;
+
+    if (!enabled)
+    {
+        timer->stop();
+        firstEdit = -1;
+    }
+}
+
+int LiveApplier::window() const
+{
+    return windowValue;
+}
+
+void LiveApplier::setWindow(int msec)
+{
+    windowValue = qBound(int(MinWindow), msec, int(MaxWindow));
+}
+
+int LiveApplier::count() const
+{
+    return applyCount;
+}
+
+int LiveApplier::lastLatency() const
+{
+    return lastValue;
+}
+
+double LiveApplier::meanLatency() const
+{
+    return applyCount ? double(sum) / applyCount : 0;
+}
+
+int LiveApplier::maxLatency() const
+{
+    return maxValue;
+}
+
+void LiveApplier::apply()
+{
+    if (!enabled)
+        return;
+
+    auto now = clock.elapsed();
+    if (firstEdit < 0)
+        firstEdit = now;
+
+    if (timer->isActive())
+    {
+        // Coalesced with the scheduled write, which will take the latest state.
+        return;
+    }
+
+    // Back-pressure: never write more often than the device manages to accept.
+    auto interval = qMax(windowValue, lastDuration);
+    timer->start(int(qMax(qint64(0), lastWrite + interval - now)));
+}
+
+void LiveApplier::onTimeout()
+{
+    auto start = clock.elapsed();
+    auto ok = mice->save(MS794::PageLighting) && mice->save(MS794::PageProfile);
+    lastWrite = clock.elapsed();
+    lastDuration = int(lastWrite - start);
+
+    if (!ok)
+    {
+        qWarning() << "Live apply: failed to write to the device";
+        firstEdit = -1;
+        emit failed();
+        return;
+    }
+
+    lastValue = int(lastWrite - firstEdit);
+    firstEdit = -1;
+    ++applyCount;
+    sum += lastValue;
+    maxValue = qMax(maxValue, lastValue);
+    emit applied(lastValue);
+}
@@ -0,0 +1,81 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LIVEAPPLIER_H
+#define LIVEAPPLIER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+
+// Writes the lighting and profile pages to the device while they are being edited.
+// The edits are coalesced into at most one write per window, and the window grows
+// when the device takes longer than that to accept a write.
+class LiveApplier : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Constants
+    {
+        DefaultWindow = 100,
+        MinWindow = 20,
+        MaxWindow = 2000,
+    };
+
+    explicit LiveApplier(class MS794 *mice, QObject *parent = 0);
+
+    bool isEnabled() const;
+    int window() const;
+
+    // Edit to device latency statistics, msec
+    int count() const;
+    int lastLatency() const;
+    double meanLatency() const;
+    int maxLatency() const;
+
+public slots:
+    void setEnabled(bool value);
+    void setWindow(int msec);
+    // The cache has new changes, write them soon.
+    void apply();
+
+signals:
+    void applied(int latency);
+    void failed();
+
+private slots:
+    void onTimeout();
+
+private:
+    class MS794 *mice;
+    class QTimer *timer;
+    QElapsedTimer clock;
+    bool enabled;
+    int windowValue;
+    // The first edit that has not reached the device yet, -1 if none
+    qint64 firstEdit;
+    qint64 lastWrite;
+    int lastDuration;
+
+    int applyCount;
+    int lastValue;
+    qint64 sum;
+    int maxValue;
+};
+
+#endif // LIVEAPPLIER_H
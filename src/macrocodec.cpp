@@ -0,0 +1,174 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "macrocodec.h"
+#include "ms794.h"
+
+#define EXTRA_DELAY 3
+
+int MacroCodec::actionSize(const MacroAction &action)
+{
+    if (action.value == 0)
+    {
+        // Unassigned key, will be skipped
+        return 0;
+    }
+
+    // Key press / button click is a down + up pair
+    int size = (action.type & MacroAction::ActionFlagDown) && (action.type & MacroAction::ActionFlagUp) ? 4 : 2;
+
+    if (action.delay > MaxShortDelay)
+    {
+        // Extra delay, or extra extra delay
+        size += action.delay / 100 > 0xFF ? 4 : 2;
+    }
+
+    return size;
+}
+
+int MacroCodec::quantizeDelay(qint64 usec)
+{
+    auto msec = (usec + 500) / 1000;
+
+    // The firmware itself uses 1 msec between the down & up events,
+    // so zero is not an option.
+    return int(qBound(qint64(1), msec, qint64(MaxDelay)));
+}
+
+QByteArray MacroCodec::encode(int repeat, const std::vector<MacroAction> &actions)
+{
+    QByteArray macro;
+    macro.reserve(MS794::MaxMacroLength);
+    macro.append(0xFF & (repeat >> 8)).append(0xFF & repeat);
+
+    foreach (const auto &action, actions)
+    {
+        auto value = action.value;
+        if (value == 0)
+        {
+            // Unassigned key, skip it
+            continue;
+        }
+
+        auto delay = qBound(0, action.delay, int(MaxDelay));
+        int extraDelay = 0;
+
+        if (delay > MaxShortDelay)
+        {
+            extraDelay = delay / 100;
+            delay %= 100;
+        }
+
+        switch (action.type & (MacroAction::ActionFlagDown | MacroAction::ActionFlagUp))
+        {
+        case MacroAction::ActionFlagDown:
+            macro.append(delay).append(value);
+            break;
+        case MacroAction::ActionFlagDown | MacroAction::ActionFlagUp:
+            macro.append(1).append(value).append(delay | 0x80).append(value);
+            break;
+        case MacroAction::ActionFlagUp:
+            macro.append(delay | 0x80).append(value);
+            break;
+        }
+
+        if (extraDelay)
+        {
+            // Extra extra delay
+            if (extraDelay > 0xFF)
+            {
+                macro.append('\x0').append(EXTRA_DELAY).append(0xFF & (extraDelay >> 8)).append(0xFF & extraDelay);
+            }
+            else
+            {
+                macro.append(extraDelay).append(EXTRA_DELAY);
+            }
+        }
+    }
+
+    if (macro.length() == 2)
+    {
+        // Empty macro, repeat count only.
+        macro.resize(0);
+    }
+
+    // Add extra zeros to mark the end of macro
+    return macro.append("\x0\x0", 2);
+}
+
+int MacroCodec::decode(const QByteArray &macro, std::vector<MacroAction> *actions)
+{
+    auto length = macro.length();
+
+    // Reads beyond the end are zeros, so we do not bother about boundaries
+    auto byte = [&macro, length](int idx) { return idx < length ? 0xFF & macro.at(idx) : 0; };
+
+    for (int i = 2; i < length; i += 2)
+    {
+        int delay = byte(i);
+        int value = byte(i + 1);
+
+        if (value == 0)
+        {
+            // End of macro
+            break;
+        }
+
+        int type = value < MS794::MouseLeftButton ? MacroAction::ActionKey : MacroAction::ActionButton;
+
+        if (delay & 0x80)
+        {
+            // Key/button up event
+            type |= MacroAction::ActionFlagUp;
+            delay &= ~0x80;
+        }
+        else if (byte(i + 3) == value && (0x80 & byte(i + 2)) && delay == 1)
+        {
+            // Down, then up => key press / button click
+            type |= MacroAction::ActionFlagDown | MacroAction::ActionFlagUp;
+            delay = 0x7F & byte(i + 2);
+            i += 2;
+        }
+        else
+        {
+            // Standalone key/button down
+            type |= MacroAction::ActionFlagDown;
+        }
+
+        // Check for extended delay
+        if (byte(i + 3) == EXTRA_DELAY)
+        {
+            // Check for extended extended delay
+            if (byte(i + 2) == 0)
+            {
+                delay += 100 * (byte(i + 4) << 8 | byte(i + 5));
+                i += 4;
+            }
+            else
+            {
+                delay += 100 * byte(i + 2);
+                i += 2;
+            }
+        }
+
+        MacroAction action = {type, value, delay};
+        actions->push_back(action);
+    }
+
+    return byte(0) << 8 | byte(1);
+}
@@ -0,0 +1,72 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MACROCODEC_H
+#define MACROCODEC_H
+
+#include <QByteArray>
+#include <vector>
+
+struct MacroAction
+{
+    enum Type
+    {
+        ActionKey = 0x01,
+        ActionButton = 0x02,
+        ActionFlagDown = 0x10,
+        ActionFlagUp = 0x20,
+
+        ActionKeyDown = ActionKey | ActionFlagDown,
+        ActionKeyUp = ActionKey | ActionFlagUp,
+        ActionKeyPress = ActionKey | ActionFlagDown | ActionFlagUp,
+
+        ActionButtonDown = ActionButton | ActionFlagDown,
+        ActionButtonUp = ActionButton | ActionFlagUp,
+        ActionButtonClick = ActionButton | ActionFlagDown | ActionFlagUp,
+    };
+
+    int type;
+    int value;
+    int delay;
+};
+
+class MacroCodec
+{
+public:
+    enum Constants
+    {
+        // Delays up to this value are stored in the event itself.
+        MaxShortDelay = 0x7F,
+        // Longer delays are stored as (delay % 100) + extra 100 msec units.
+        MaxDelay = 0xFFFF * 100 + 99,
+        // Repeat count + end of macro mark.
+        Overhead = 4,
+    };
+
+    // Returns the number of bytes the action takes in the encoded macro.
+    static int actionSize(const MacroAction &action);
+
+    // Rounds the delay (in microseconds) to the nearest one the device can store.
+    static int quantizeDelay(qint64 usec);
+
+    static QByteArray encode(int repeat, const std::vector<MacroAction> &actions);
+    // Returns the repeat count.
+    static int decode(const QByteArray &macro, std::vector<MacroAction> *actions);
+};
+
+#endif // MACROCODEC_H
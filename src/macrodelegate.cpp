@@ -0,0 +1,87 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "macrodelegate.h"
+#include "macroedit.h"
+#include "macromodel.h"
+
+MacroDelegate::MacroDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+    , rowHeight(0)
+{
+}
+
+QWidget *MacroDelegate::createEditor(QWidget *parent, const QStyleOptionViewItem &, const QModelIndex &index) const
+{
+    auto type = index.data(MacroModel::TypeRole).toInt();
+    auto editor = new MacroEdit(MacroEdit::ActionType(type), parent);
+
+    // Commit on every change, so the model is always up to date.
+    connect(editor, SIGNAL(changed()), this, SLOT(onEditorChanged()));
+    return editor;
+}
+
+void MacroDelegate::setEditorData(QWidget *editor, const QModelIndex &index) const
+{
+    auto edit = static_cast<MacroEdit *>(editor);
+    auto value = index.data(MacroModel::ValueRole).toInt();
+    auto delay = index.data(MacroModel::DelayRole).toInt();
+
+    // The view calls this on every commit. Do not touch the text the user is typing in.
+    if (edit->value() == value && edit->delay() == delay)
+        return;
+
+    auto block = edit->blockSignals(true);
+    edit->setValue(value);
+    edit->setDelay(delay);
+    edit->blockSignals(block);
+}
+
+void MacroDelegate::setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const
+{
+    auto edit = static_cast<MacroEdit *>(editor);
+
+    if (index.data(MacroModel::ValueRole).toInt() != edit->value())
+        model->setData(index, edit->value(), MacroModel::ValueRole);
+
+    if (index.data(MacroModel::DelayRole).toInt() != edit->delay())
+        model->setData(index, edit->delay(), MacroModel::DelayRole);
+}
+
+void MacroDelegate::updateEditorGeometry(QWidget *editor, const QStyleOptionViewItem &option, const QModelIndex &) const
+{
+    editor->setGeometry(option.rect);
+}
+
+QSize MacroDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    if (!rowHeight)
+    {
+        MacroEdit prototype(MacroEdit::ActionKeyPress);
+        rowHeight = prototype.sizeHint().height();
+    }
+
+    auto size = QStyledItemDelegate::sizeHint(option, index);
+    size.setHeight(qMax(size.height(), rowHeight));
+    return size;
+}
+
+void MacroDelegate::onEditorChanged()
+{
+    emit commitData(static_cast<QWidget *>(sender()));
+}
@@ -21,17 +21,10 @@
 #include "mousebuttonbox.h"
 #include "ms794.h"
 
-#include <QAction>
-#include <QComboBox>
 #include <QDebug>
 #include <QHBoxLayout>
 #include <QLabel>
-#include <QLineEdit>
-#include <QMenu>
-#include <QPushButton>
 #include <QSpinBox>
-#include <QStyle>
-#include <QxtCheckComboBox>
 
 MacroEdit::MacroEdit(ActionType actionType, QWidget *parent)
     : QWidget(parent)
@@ -54,6 +47,7 @@ MacroEdit::MacroEdit(ActionType actionType, QWidget *parent)
         layout->addWidget(key);
         setFocusProxy(key);
         title->setBuddy(key);
+        connect(key, SIGNAL(textChanged(QString)), this, SIGNAL(changed()));
 
         switch (actionType & (ActionFlagDown | ActionFlagUp))
         {
@@ -78,6 +72,7 @@ MacroEdit::MacroEdit(ActionType actionType, QWidget *parent)
         layout->addWidget(button);
         setFocusProxy(button);
         title->setBuddy(button);
+        connect(button, SIGNAL(currentIndexChanged(int)), this, SIGNAL(changed()));
 
         switch (actionType & (ActionFlagDown | ActionFlagUp))
         {
@@ -103,26 +98,10 @@ MacroEdit::MacroEdit(ActionType actionType, QWidget *parent)
     spinDelay->setValue(10);
     layout->addWidget(spinDelay);
     layout->addStretch();
+    connect(spinDelay, SIGNAL(valueChanged(int)), this, SIGNAL(changed()));
 
-    // UI buttons
-    auto moveDown = new QPushButton(style()->standardIcon(QStyle::SP_ArrowDown), QString());
-    moveDown->setToolTip(tr("Move down"));
-    connect(moveDown, SIGNAL(clicked(bool)), this, SLOT(moveDown()));
-    moveDown->setFlat(true);
-    layout->addWidget(moveDown);
-
-    auto moveUp = new QPushButton(style()->standardIcon(QStyle::SP_ArrowUp), QString());
-    moveUp->setToolTip(tr("Move up"));
-    connect(moveUp, SIGNAL(clicked(bool)), this, SLOT(moveUp()));
-    moveUp->setFlat(true);
-    layout->addWidget(moveUp);
-
-    auto remove = new QPushButton(style()->standardIcon(QStyle::SP_DialogDiscardButton), QString());
-    remove->setToolTip(tr("Remove"));
-    connect(remove, SIGNAL(clicked(bool)), this, SLOT(deleteLater()));
-    remove->setFlat(true);
-    layout->addWidget(remove);
-
+    // Covers the item text when used as an item editor
+    setAutoFillBackground(true);
     setLayout(layout);
 }
 
@@ -157,27 +136,3 @@ int MacroEdit::delay() const
 {
     return spinDelay->value();
 }
-
-void MacroEdit::moveUp()
-{
-    auto parentLayout = static_cast<QBoxLayout *>(parentWidget()->layout());
-    auto idx = parentLayout->indexOf(this);
-
-    if (idx > 0)
-    {
-        parentLayout->takeAt(idx);
-        parentLayout->insertWidget(--idx, this);
-    }
-}
-
-void MacroEdit::moveDown()
-{
-    auto parentLayout = static_cast<QBoxLayout *>(parentWidget()->layout());
-    auto idx = parentLayout->indexOf(this);
-
-    if (idx < parentLayout->count() - 3)
-    {
-        parentLayout->takeAt(idx);
-        parentLayout->insertWidget(++idx, this);
-    }
-}
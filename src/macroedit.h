@@ -19,6 +19,8 @@
 #ifndef MACROEDIT_H
 #define MACROEDIT_H
 
+#include "macrocodec.h"
+
 #include <QWidget>
 
 QT_FORWARD_DECLARE_CLASS(QComboBox)
@@ -36,18 +38,18 @@ class MacroEdit : public QWidget
 public:
     enum ActionType
     {
-        ActionKey = 0x01,
-        ActionButton = 0x02,
-        ActionFlagDown = 0x10,
-        ActionFlagUp = 0x20,
-
-        ActionKeyDown = ActionKey | ActionFlagDown,
-        ActionKeyUp = ActionKey | ActionFlagUp,
-        ActionKeyPress = ActionKey | ActionFlagDown | ActionFlagUp,
-
-        ActionButtonDown = ActionButton | ActionFlagDown,
-        ActionButtonUp = ActionButton | ActionFlagUp,
-        ActionButtonClick = ActionButton | ActionFlagDown | ActionFlagUp,
+        ActionKey = MacroAction::ActionKey,
+        ActionButton = MacroAction::ActionButton,
+        ActionFlagDown = MacroAction::ActionFlagDown,
+        ActionFlagUp = MacroAction::ActionFlagUp,
+
+        ActionKeyDown = MacroAction::ActionKeyDown,
+        ActionKeyUp = MacroAction::ActionKeyUp,
+        ActionKeyPress = MacroAction::ActionKeyPress,
+
+        ActionButtonDown = MacroAction::ActionButtonDown,
+        ActionButtonUp = MacroAction::ActionButtonUp,
+        ActionButtonClick = MacroAction::ActionButtonClick,
     };
 
     explicit MacroEdit(ActionType actionType, QWidget *parent = 0);
@@ -60,9 +62,8 @@ public:
     int value() const;
     void setValue(int value);
 
-public slots:
-    void moveUp();
-    void moveDown();
+signals:
+    void changed();
 
 private:
     ActionType actionTypeValue;
@@ -0,0 +1,179 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "macromodel.h"
+#include "ms794.h"
+#include "usbscancodes.h"
+
+#include <algorithm>
+
+MacroModel::MacroModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+    items.reserve(MS794::MaxMacroLength / 2);
+}
+
+const std::vector<MacroAction> &MacroModel::actions() const
+{
+    return items;
+}
+
+void MacroModel::setActions(const std::vector<MacroAction> &actions)
+{
+    beginResetModel();
+    // Keeps the capacity, so switching between the macros does not allocate.
+    items.assign(actions.cbegin(), actions.cend());
+    endResetModel();
+}
+
+int MacroModel::encodedSize() const
+{
+    int size = MacroCodec::Overhead;
+    foreach (const auto &action, items)
+    {
+        size += MacroCodec::actionSize(action);
+    }
+    return size;
+}
+
+QModelIndex MacroModel::appendAction(const MacroAction &action)
+{
+    int row = int(items.size());
+    beginInsertRows(QModelIndex(), row, row);
+    items.push_back(action);
+    endInsertRows();
+    return index(row);
+}
+
+bool MacroModel::moveAction(int from, int to)
+{
+    int count = int(items.size());
+    if (from < 0 || from >= count || to < 0 || to >= count || from == to)
+        return false;
+
+    // For the move down, the destination is the row after the target one.
+    if (!beginMoveRows(QModelIndex(), from, from, QModelIndex(), to > from ? to + 1 : to))
+        return false;
+
+    auto first = items.begin();
+    if (from < to)
+        std::rotate(first + from, first + from + 1, first + to + 1);
+    else
+        std::rotate(first + to, first + from, first + from + 1);
+
+    endMoveRows();
+    return true;
+}
+
+QString MacroModel::actionName(int type)
+{
+    switch (type)
+    {
+    case MacroAction::ActionKeyPress:
+        return tr("Key Press");
+    case MacroAction::ActionKeyDown:
+        return tr("Key Down");
+    case MacroAction::ActionKeyUp:
+        return tr("Key Up");
+    case MacroAction::ActionButtonClick:
+        return tr("Button Click");
+    case MacroAction::ActionButtonDown:
+        return tr("Button Down");
+    case MacroAction::ActionButtonUp:
+        return tr("Button Up");
+    }
+
+    return QString();
+}
+
+int MacroModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : int(items.size());
+}
+
+QVariant MacroModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= int(items.size()))
+        return QVariant();
+
+    const auto &action = items[index.row()];
+
+    switch (role)
+    {
+    case Qt::DisplayRole:
+    {
+        QString name = UsbScanCodes::name(action.value);
+        if (name.isEmpty() && action.value)
+            name = QString("%1").arg(action.value, 4, 16, QChar('0'));
+
+        return tr("%1   %2   delay %3 msec").arg(actionName(action.type), name).arg(action.delay);
+    }
+
+    case TypeRole:
+        return action.type;
+
+    case ValueRole:
+        return action.value;
+
+    case DelayRole:
+        return action.delay;
+    }
+
+    return QVariant();
+}
+
+bool MacroModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || index.row() >= int(items.size()))
+        return false;
+
+    auto &action = items[index.row()];
+
+    switch (role)
+    {
+    case ValueRole:
+        action.value = value.toInt();
+        break;
+
+    case DelayRole:
+        action.delay = qBound(0, value.toInt(), int(MacroCodec::MaxDelay));
+        break;
+
+    default:
+        return false;
+    }
+
+    emit dataChanged(index, index);
+    return true;
+}
+
+Qt::ItemFlags MacroModel::flags(const QModelIndex &index) const
+{
+    return QAbstractListModel::flags(index) | Qt::ItemIsEditable;
+}
+
+bool MacroModel::removeRows(int row, int count, const QModelIndex &parent)
+{
+    if (parent.isValid() || row < 0 || count <= 0 || row + count > int(items.size()))
+        return false;
+
+    beginRemoveRows(QModelIndex(), row, row + count - 1);
+    items.erase(items.begin() + row, items.begin() + row + count);
+    endRemoveRows();
+    return true;
+}
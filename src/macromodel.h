@@ -0,0 +1,62 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MACROMODEL_H
+#define MACROMODEL_H
+
+#include "macrocodec.h"
+
+#include <QAbstractListModel>
+
+// The decoded macro, one row per action.
+class MacroModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Role
+    {
+        TypeRole = Qt::UserRole,
+        ValueRole,
+        DelayRole,
+    };
+
+    explicit MacroModel(QObject *parent = 0);
+
+    const std::vector<MacroAction> &actions() const;
+    void setActions(const std::vector<MacroAction> &actions);
+
+    // The size of the encoded macro, in bytes.
+    int encodedSize() const;
+
+    QModelIndex appendAction(const MacroAction &action);
+    bool moveAction(int from, int to);
+
+    static QString actionName(int type);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole);
+    Qt::ItemFlags flags(const QModelIndex &index) const;
+    bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex());
+
+private:
+    std::vector<MacroAction> items;
+};
+
+#endif // MACROMODEL_H
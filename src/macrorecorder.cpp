@@ -0,0 +1,270 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "macrorecorder.h"
+#include "ms794.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+
+#ifdef Q_OS_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef input_event_sec
+#define input_event_sec time.tv_sec
+#define input_event_usec time.tv_usec
+#endif
+
+// https://git.kernel.org/pub/scm/linux/kernel/git/torvalds/linux.git/tree/drivers/hid/hid-input.c (hid_keyboard)
+// USB HID usage => Linux key code. Zero means unknown.
+static const quint8 hidKeyboard[256] =
+{
+      0,  0,  0,  0, 30, 48, 46, 32, 18, 33, 34, 35, 23, 36, 37, 38,
+     50, 49, 24, 25, 16, 19, 31, 20, 22, 47, 17, 45, 21, 44,  2,  3,
+      4,  5,  6,  7,  8,  9, 10, 11, 28,  1, 14, 15, 57, 12, 13, 26,
+     27, 43, 43, 39, 40, 41, 51, 52, 53, 58, 59, 60, 61, 62, 63, 64,
+     65, 66, 67, 68, 87, 88, 99, 70,119,110,102,104,111,107,109,106,
+    105,108,103, 69, 98, 55, 74, 78, 96, 79, 80, 81, 75, 76, 77, 71,
+     72, 73, 82, 83, 86,127,116,117,183,184,185,186,187,188,189,190,
+    191,192,193,194,134,138,130,132,128,129,131,137,133,135,136,113,
+    115,114,  0,  0,  0,121,  0, 89, 93,124, 92, 94, 95,  0,  0,  0,
+    122,123, 90, 91, 85,  0,  0,  0,  0,  0,  0,  0,111,  0,  0,  0,
+      0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+      0,  0,  0,  0,  0,  0,179,180,  0,  0,  0,  0,  0,  0,  0,  0,
+      0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+      0,  0,  0,  0,  0,  0,  0,  0,111,  0,  0,  0,  0,  0,  0,  0,
+     29, 42, 56,125, 97, 54,100,126,164,166,165,163,161,115,114,113,
+    150,158,159,128,136,177,178,176,142,152,173,140,  0,  0,  0,  0,
+};
+
+static std::vector<quint8> buildUsageTable()
+{
+    std::vector<quint8> table(256, 0);
+
+    // Several usages may produce the same key code. The first one wins,
+    // except the media keys, since the mouse firmware has them at 0xE8..0xEF.
+    for (int usage = 0; usage < MS794::MouseLeftButton; ++usage)
+    {
+        auto code = hidKeyboard[usage];
+        if (code && (!table[code] || usage >= 0xE8))
+            table[code] = quint8(usage);
+    }
+
+    return table;
+}
+
+// Linux key code => USB HID usage (or the mouse button code). Zero means unknown.
+static int usageFromKeyCode(int code)
+{
+    static const std::vector<quint8> usages = buildUsageTable();
+
+    if (code >= BTN_LEFT && code <= BTN_EXTRA)
+        return MS794::MouseLeftButton + code - BTN_LEFT;
+
+    return code > 0 && code < int(usages.size()) ? usages[code] : 0;
+}
+#endif
+
+MacroRecorder::MacroRecorder(QObject *parent)
+    : QThread(parent)
+    , fd(-1)
+    , recordedSize(MacroCodec::Overhead)
+    , full(false)
+    , lastEventTime(0)
+{
+}
+
+MacroRecorder::~MacroRecorder()
+{
+    close();
+}
+
+QStringList MacroRecorder::inputDevices()
+{
+    QStringList devices;
+#ifdef Q_OS_LINUX
+    QDir dir("/dev/input");
+    foreach (auto name, dir.entryList(QStringList("event*"), QDir::System))
+    {
+        devices << dir.absoluteFilePath(name);
+    }
+#endif
+    return devices;
+}
+
+bool MacroRecorder::open(const QString &path)
+{
+    close();
+
+    recorded.clear();
+    recordedSize = MacroCodec::Overhead;
+    full = false;
+    lastEventTime = 0;
+
+#ifdef Q_OS_LINUX
+    fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+    {
+        qWarning() << "Failed to open" << path << "error" << errno;
+        return false;
+    }
+
+    // Kernel timestamps should not jump with the wall clock.
+    // Fails for the recorded files, which is fine.
+    int clockId = CLOCK_MONOTONIC;
+    ioctl(fd, EVIOCSCLOCKID, &clockId);
+    return true;
+#else
+    qWarning() << "Recording from" << path << "is not supported on this platform";
+    return false;
+#endif
+}
+
+void MacroRecorder::close()
+{
+    requestInterruption();
+    wait();
+
+#ifdef Q_OS_LINUX
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+std::vector<MacroAction> MacroRecorder::actions() const
+{
+    QMutexLocker lock(&mutex);
+    return recorded;
+}
+
+int MacroRecorder::size() const
+{
+    QMutexLocker lock(&mutex);
+    return recordedSize;
+}
+
+bool MacroRecorder::isFull() const
+{
+    QMutexLocker lock(&mutex);
+    return full;
+}
+
+void MacroRecorder::run()
+{
+#ifdef Q_OS_LINUX
+    input_event events[64];
+    pollfd pfd = {fd, POLLIN, 0};
+
+    while (!isInterruptionRequested())
+    {
+        // Wake up from time to time to check for the stop request.
+        auto rc = poll(&pfd, 1, 100);
+        if (rc == 0 || (rc < 0 && errno == EINTR))
+            continue;
+
+        // Read as many events as possible in one go.
+        auto bytes = rc < 0 ? rc : ::read(fd, events, sizeof(events));
+        if (bytes < 0 && (errno == EINTR || errno == EAGAIN))
+            continue;
+
+        if (bytes <= 0)
+        {
+            // The end of the recorded file or the device is gone.
+            break;
+        }
+
+        QMutexLocker lock(&mutex);
+        auto count = recorded.size();
+
+        for (size_t i = 0; i < size_t(bytes) / sizeof(input_event) && !full; ++i)
+        {
+            const auto &ev = events[i];
+
+            // Skip autorepeat, the device will do it for us.
+            if (ev.type != EV_KEY || ev.value > 1)
+                continue;
+
+            auto usec = qint64(ev.input_event_sec) * 1000000 + ev.input_event_usec;
+            full = !processEvent(usec, ev.code, ev.value);
+        }
+
+        auto changed = count != recorded.size();
+        auto size = recordedSize;
+        auto stop = full;
+        lock.unlock();
+
+        if (changed)
+            emit sizeChanged(size);
+
+        if (stop)
+            break;
+    }
+#endif
+}
+
+bool MacroRecorder::processEvent(qint64 usec, int code, int value)
+{
+#ifdef Q_OS_LINUX
+    auto usage = usageFromKeyCode(code);
+    if (usage == 0)
+    {
+        // Nothing the mouse can replay.
+        return true;
+    }
+
+    int type = usage < MS794::MouseLeftButton ? MacroAction::ActionKey : MacroAction::ActionButton;
+    type |= value ? MacroAction::ActionFlagDown : MacroAction::ActionFlagUp;
+
+    MacroAction action = {type, usage, 1};
+    auto extra = MacroCodec::actionSize(action);
+
+    // The delay is stored after the event, so the gap goes to the previous one.
+    MacroAction prev = {0, 0, 0};
+    if (!recorded.empty())
+    {
+        prev = recorded.back();
+        prev.delay = MacroCodec::quantizeDelay(usec - lastEventTime);
+        extra += MacroCodec::actionSize(prev) - MacroCodec::actionSize(recorded.back());
+    }
+
+    if (recordedSize + extra > MS794::MaxMacroLength)
+        return false;
+
+    if (!recorded.empty())
+        recorded.back() = prev;
+
+    recorded.push_back(action);
+    recordedSize += extra;
+    lastEventTime = usec;
+#else
+    Q_UNUSED(usec);
+    Q_UNUSED(code);
+    Q_UNUSED(value);
+#endif
+    return true;
+}
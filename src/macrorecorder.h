@@ -0,0 +1,66 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MACRORECORDER_H
+#define MACRORECORDER_H
+
+#include "macrocodec.h"
+
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+
+// Records key & button events from a Linux input device (/dev/input/eventN)
+// or from a file with raw input_event structures.
+class MacroRecorder : public QThread
+{
+    Q_PROPERTY(int size READ size)
+
+    Q_OBJECT
+
+public:
+    explicit MacroRecorder(QObject *parent = 0);
+    ~MacroRecorder();
+
+    bool open(const QString &path);
+    void close();
+
+    std::vector<MacroAction> actions() const;
+    int size() const;
+    bool isFull() const;
+
+    static QStringList inputDevices();
+
+signals:
+    void sizeChanged(int bytes);
+
+protected:
+    void run();
+
+private:
+    bool processEvent(qint64 usec, int code, int value);
+
+    int fd;
+    int recordedSize;
+    bool full;
+    qint64 lastEventTime;
+    std::vector<MacroAction> recorded;
+    mutable QMutex mutex;
+};
+
+#endif // MACRORECORDER_H
@@ -0,0 +1,203 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "macrotracer.h"
+#include "macrocodec.h"
+#include "ms794.h"
+#include "qhidreportreader.h"
+
+#include <qxtglobal.h>
+#include <QDebug>
+
+// Boot protocol keyboard report: modifiers, reserved, 6 keys.
+#define KEYBOARD_REPORT_LENGTH 8
+#define KEYBOARD_FIRST_MODIFIER 0xE0
+
+MacroTracer::MacroTracer(MS794 *mice, QObject *parent)
+    : QObject(parent)
+    , mice(mice)
+    , reader(nullptr)
+    , matched(0)
+    , dropped(0)
+    , lastTimestamp(0)
+{
+    memset(keys, 0, sizeof(keys));
+}
+
+MacroTracer::~MacroTracer()
+{
+    stop();
+}
+
+bool MacroTracer::start(int macroIndex)
+{
+    stop();
+
+    auto macro = mice->macro(macroIndex);
+    if (macro.isNull())
+        return false;
+
+    std::vector<MacroAction> actions;
+    MacroCodec::decode(macro, &actions);
+
+    // Build the timeline the firmware is expected to play.
+    // Mouse buttons are not seen on the keyboard interface, but their delays still count.
+    expected.clear();
+    qint64 time = 0;
+    qint64 prevKeyTime = -1;
+
+    foreach (const auto &action, actions)
+    {
+        auto isKey = (action.type & MacroAction::ActionKey) != 0;
+        auto events = {MacroAction::ActionFlagDown, MacroAction::ActionFlagUp};
+
+        foreach (auto flag, events)
+        {
+            if (!(action.type & flag))
+                continue;
+
+            if (isKey)
+            {
+                Step step = {action.value, flag == MacroAction::ActionFlagDown,
+                    prevKeyTime < 0 ? -1 : int(time - prevKeyTime), -1};
+                expected.push_back(step);
+                prevKeyTime = time;
+            }
+
+            // The firmware holds the key for 1 msec for a key press
+            time += (action.type & MacroAction::ActionFlagUp) && flag == MacroAction::ActionFlagDown ? 1 : action.delay;
+        }
+    }
+
+    if (expected.empty())
+    {
+        qWarning() << "The macro" << macroIndex << "has no keyboard events to trace";
+        return false;
+    }
+
+    matched = 0;
+    dropped = 0;
+    lastTimestamp = 0;
+    memset(keys, 0, sizeof(keys));
+
+    reader = new QHIDReportReader(mice->hidDevice(), this);
+    connect(reader, SIGNAL(reportsAvailable()), this, SLOT(onReportsAvailable()));
+    reader->start(QThread::TimeCriticalPriority);
+    return true;
+}
+
+void MacroTracer::stop()
+{
+    if (reader)
+    {
+        reader->stop();
+        dropped = reader->droppedCount();
+        delete reader;
+        reader = nullptr;
+    }
+}
+
+bool MacroTracer::isComplete() const
+{
+    return !expected.empty() && matched == expected.size();
+}
+
+int MacroTracer::droppedCount() const
+{
+    return reader ? reader->droppedCount() : dropped;
+}
+
+const std::vector<MacroTracer::Step> &MacroTracer::steps() const
+{
+    return expected;
+}
+
+void MacroTracer::onReportsAvailable()
+{
+    QHIDReport reports[64];
+    int count;
+
+    while (reader && (count = reader->takeReports(reports, int(_countof(reports)))) > 0)
+    {
+        for (int i = 0; i < count && !isComplete(); ++i)
+        {
+            processReport(reports[i]);
+        }
+    }
+
+    if (isComplete())
+    {
+        emit completed();
+    }
+}
+
+void MacroTracer::processReport(const QHIDReport &report)
+{
+    if (report.length < KEYBOARD_REPORT_LENGTH)
+        return;
+
+    // Skip the report id, if any
+    auto data = (const quint8 *)report.data + report.length - KEYBOARD_REPORT_LENGTH;
+
+    bool pressed[256] = {false};
+    for (int bit = 0; bit < 8; ++bit)
+    {
+        pressed[KEYBOARD_FIRST_MODIFIER + bit] = (data[0] >> bit) & 1;
+    }
+
+    for (int i = 2; i < KEYBOARD_REPORT_LENGTH; ++i)
+    {
+        // 1..3 are error codes (rollover etc)
+        if (data[i] > 3)
+            pressed[data[i]] = true;
+    }
+
+    // Releases first, then presses
+    for (int value = 0; value < 256; ++value)
+    {
+        if (keys[value] && !pressed[value])
+            processEvent(report.timestamp, value, false);
+    }
+
+    for (int value = 0; value < 256; ++value)
+    {
+        if (!keys[value] && pressed[value])
+            processEvent(report.timestamp, value, true);
+    }
+
+    memcpy(keys, pressed, sizeof(keys));
+}
+
+void MacroTracer::processEvent(qint64 timestamp, int value, bool down)
+{
+    if (isComplete())
+        return;
+
+    auto &step = expected[matched];
+    if (step.value != value || step.down != down)
+    {
+        // Not a part of the macro (yet), the user may type something.
+        return;
+    }
+
+    if (matched > 0)
+        step.observed = (timestamp - lastTimestamp) / 1000000.0;
+
+    lastTimestamp = timestamp;
+    ++matched;
+}
@@ -0,0 +1,70 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MACROTRACER_H
+#define MACROTRACER_H
+
+#include <QObject>
+#include <vector>
+
+// Watches the keyboard reports the mouse sends while playing a macro
+// and compares the observed timing with the encoded delays.
+class MacroTracer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Step
+    {
+        int value;
+        bool down;
+        // Both are msec since the previous key event, the first step has none.
+        int expected;
+        double observed;
+    };
+
+    explicit MacroTracer(class MS794 *mice, QObject *parent = 0);
+    ~MacroTracer();
+
+    bool start(int macroIndex);
+    void stop();
+
+    bool isComplete() const;
+    int droppedCount() const;
+    const std::vector<Step> &steps() const;
+
+signals:
+    void completed();
+
+private slots:
+    void onReportsAvailable();
+
+private:
+    void processReport(const struct QHIDReport &report);
+    void processEvent(qint64 timestamp, int value, bool down);
+
+    class MS794 *mice;
+    class QHIDReportReader *reader;
+    std::vector<Step> expected;
+    size_t matched;
+    int dropped;
+    qint64 lastTimestamp;
+    bool keys[256];
+};
+
+#endif // MACROTRACER_H
@@ -16,20 +16,60 @@
  *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include "buttonbinding.h"
+#include "lightingeffect.h"
+#include "lightingengine.h"
 #include "mainwindow.h"
+#include "macrorecorder.h"
+#include "macrotracer.h"
 #include "ms794.h"
+#include "qhidflightrecorder.h"
+#include "qhidstats.h"
+#include "qhidtrace.h"
+#include "reportrateanalyzer.h"
 
 #include <QApplication>
 #include <QCommandLineParser>
 #include <QDebug>
+#include <QEventLoop>
 #include <QFile>
+#include <QJsonDocument>
+#include <QTextStream>
 #include <QThread>
+#include <QTimer>
+
+#include <math.h>
 
 inline QString tr(const char *str)
 {
     return QCoreApplication::translate("main", str);
 }
 
+// Saves the device I/O trace, the flight recorder & the statistics on any exit path.
+struct IoReports
+{
+    QString path;
+    QString recorderPath;
+    bool printStats;
+
+    IoReports()
+        : printStats(false)
+    {
+    }
+
+    ~IoReports()
+    {
+        if (printStats)
+            QTextStream(stdout) << QJsonDocument(QHIDStats::toJson()).toJson();
+
+        if (!path.isEmpty() && !QHIDTrace::save(path))
+            qWarning() << "Failed to write the trace to" << path;
+
+        if (!recorderPath.isEmpty() && !QHIDFlightRecorder::dump(recorderPath, "on demand"))
+            qWarning() << "Failed to write the last device transactions to" << recorderPath;
+    }
+};
+
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
@@ -50,10 +90,38 @@ int main(int argc, char *argv[])
     parser.addOption(reportRateOption);
     QCommandLineOption setReportRateOption(QStringList() << "R" << "set-rate", tr("Select the active report <rate>."), tr("rate"));
     parser.addOption(setReportRateOption);
+    QCommandLineOption buttonOption(QStringList() << "button", tr("Get the binding of the button <index>."), tr("index"));
+    parser.addOption(buttonOption);
+    QCommandLineOption setButtonOption(QStringList() << "set-button", tr("Bind the button <index>, i.e. \"3=key LCtrl+C\"."), tr("index=binding"));
+    parser.addOption(setButtonOption);
+    QCommandLineOption analyzeRateOption(QStringList() << "analyze-rate", tr("Measure the actual report rate for <seconds> (move the mouse meanwhile)."), tr("seconds"));
+    parser.addOption(analyzeRateOption);
     QCommandLineOption backupOption(QStringList() << "backup", tr("Backup NAND data to a <file>."), tr("file"));
     parser.addOption(backupOption);
     QCommandLineOption restoreOption(QStringList() << "restore", tr("Restore NAND data from a <file>."), tr("file"));
     parser.addOption(restoreOption);
+    QCommandLineOption recordMacroOption(QStringList() << "record-macro", tr("Record the macro <index> from an input device."), tr("index"));
+    parser.addOption(recordMacroOption);
+    QCommandLineOption recordDeviceOption(QStringList() << "record-device", tr("Input <device> or a file with recorded events."), tr("device"));
+    parser.addOption(recordDeviceOption);
+    QCommandLineOption recordTimeOption(QStringList() << "record-time", tr("Stop recording after <seconds>."), tr("seconds"), "10");
+    parser.addOption(recordTimeOption);
+    QCommandLineOption traceMacroOption(QStringList() << "trace-macro", tr("Compare the timing of the macro <index> played by the mouse with the encoded one."), tr("index"));
+    parser.addOption(traceMacroOption);
+    QCommandLineOption traceTimeOption(QStringList() << "trace-time", tr("Stop tracing after <seconds>."), tr("seconds"), "30");
+    parser.addOption(traceTimeOption);
+    QCommandLineOption effectOption(QStringList() << "effect", tr("Run the host computed lighting <effect>: rainbow, pulse[:color], cpu or status:file."), tr("effect"));
+    parser.addOption(effectOption);
+    QCommandLineOption effectTimeOption(QStringList() << "effect-time", tr("Stop the effect after <seconds>, 0 to run forever."), tr("seconds"), "60");
+    parser.addOption(effectTimeOption);
+    QCommandLineOption effectFpsOption(QStringList() << "effect-fps", tr("Limit the effect to <fps> device writes per second."), tr("fps"), QString::number(LightingEngine::DefaultFps));
+    parser.addOption(effectFpsOption);
+    QCommandLineOption traceOption(QStringList() << "trace", tr("Record the device I/O to a <file> in the Chrome trace format."), tr("file"));
+    parser.addOption(traceOption);
+    QCommandLineOption dumpIoOption(QStringList() << "dump-io", tr("Write the last device transactions to a <file> on exit."), tr("file"));
+    parser.addOption(dumpIoOption);
+    QCommandLineOption statsOption(QStringList() << "stats", tr("Print the device I/O statistics in JSON format on exit."));
+    parser.addOption(statsOption);
     QCommandLineOption verboseOption(QStringList() << "verbose", tr("Verbose output."));
     parser.addOption(verboseOption);
 
@@ -65,8 +133,20 @@ int main(int argc, char *argv[])
         QLoggingCategory::setFilterRules("*.debug=false");
     }
 
+    IoReports ioReports;
+    if (parser.isSet(traceOption))
+    {
+        ioReports.path = parser.value(traceOption);
+        QHIDTrace::setEnabled(true);
+    }
+    ioReports.recorderPath = parser.value(dumpIoOption);
+    ioReports.printStats = parser.isSet(statsOption);
+
     auto optionsNames = parser.optionNames();
     optionsNames.removeAll("verbose");
+    optionsNames.removeAll("trace");
+    optionsNames.removeAll("dump-io");
+    optionsNames.removeAll("stats");
 
     if (optionsNames.isEmpty())
     {
@@ -76,7 +156,6 @@ int main(int argc, char *argv[])
     }
 
     MS794 mice;
-
     if (!mice.ping())
     {
         qWarning() << "The device was not found.";
@@ -127,6 +206,188 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    if (parser.isSet(recordMacroOption))
+    {
+        auto index = parser.value(recordMacroOption).toInt();
+        if (index < 1 || index > MS794::MaxMacroNum)
+        {
+            qWarning() << "The macro index must be in range 1 ..." << MS794::MaxMacroNum;
+            return 2;
+        }
+
+        MacroRecorder recorder;
+        auto path = parser.value(recordDeviceOption);
+        if (path.isEmpty())
+        {
+            // Pick the first one.
+            path = MacroRecorder::inputDevices().value(0);
+        }
+
+        if (!recorder.open(path))
+        {
+            qWarning() << "Failed to open" << path << "for reading.";
+            return 2;
+        }
+
+        qWarning() << "Recording from" << path << "...";
+        recorder.start(QThread::HighPriority);
+        if (!recorder.wait(1000UL * parser.value(recordTimeOption).toUInt()))
+        {
+            recorder.requestInterruption();
+            recorder.wait();
+        }
+
+        if (recorder.actions().empty())
+        {
+            // Keep the macro on the device intact
+            qWarning() << "Nothing was recorded.";
+            return 4;
+        }
+
+        auto macro = MacroCodec::encode(1, recorder.actions());
+        qWarning() << "Recorded" << recorder.actions().size() << "events," << macro.length() << "of"
+                   << MS794::MaxMacroLength << "bytes.";
+
+        mice.setMacro(index, macro);
+        if (!mice.save())
+        {
+            qWarning() << "Failed to write the macro.";
+            return 3;
+        }
+
+        return 0;
+    }
+
+    if (parser.isSet(traceMacroOption))
+    {
+        auto index = parser.value(traceMacroOption).toInt();
+        if (index < 1 || index > MS794::MaxMacroNum)
+        {
+            qWarning() << "The macro index must be in range 1 ..." << MS794::MaxMacroNum;
+            return 2;
+        }
+
+        MacroTracer tracer(&mice);
+        if (!tracer.start(index))
+        {
+            qWarning() << "Failed to start tracing.";
+            return 3;
+        }
+
+        qWarning() << "Waiting for the macro" << index << "to be played...";
+        QEventLoop loop;
+        QObject::connect(&tracer, SIGNAL(completed()), &loop, SLOT(quit()));
+        QTimer::singleShot(1000 * parser.value(traceTimeOption).toInt(), &loop, SLOT(quit()));
+        loop.exec();
+        tracer.stop();
+
+        QTextStream out(stdout);
+        out << "step\tkey\tevent\texpected_ms\tobserved_ms\terror_ms\n";
+
+        int count = 0;
+        double sum = 0, sumSquares = 0, worst = 0;
+        auto steps = tracer.steps();
+        for (size_t i = 0; i < steps.size(); ++i)
+        {
+            const auto &step = steps[i];
+            out << i << '\t' << QString::number(step.value, 16) << '\t' << (step.down ? "down" : "up") << '\t';
+
+            if (step.expected < 0 || step.observed < 0)
+            {
+                out << (step.expected < 0 ? "-" : QString::number(step.expected)) << "\t-\t-\n";
+                continue;
+            }
+
+            auto error = step.observed - step.expected;
+            out << step.expected << '\t' << step.observed << '\t' << error << '\n';
+
+            ++count;
+            sum += error;
+            sumSquares += error * error;
+            worst = qMax(worst, qAbs(error));
+        }
+
+        if (count > 0)
+        {
+            auto mean = sum / count;
+            out << "# mean error " << mean << " ms, jitter (stddev) " << sqrt(qMax(0.0, sumSquares / count - mean * mean))
+                << " ms, worst " << worst << " ms\n";
+        }
+
+        if (tracer.droppedCount() > 0)
+        {
+            out << "# dropped reports " << tracer.droppedCount() << "\n";
+        }
+
+        if (!tracer.isComplete())
+        {
+            qWarning() << "The macro was not played completely.";
+            return 4;
+        }
+
+        return 0;
+    }
+
+    if (parser.isSet(analyzeRateOption))
+    {
+        auto rate = mice.reportRate();
+        if (rate < 1)
+        {
+            qWarning() << "Failed to read the report rate.";
+            return 3;
+        }
+
+        ReportRateAnalyzer analyzer;
+        if (!analyzer.start(125 * (1 << (rate - 1))))
+        {
+            qWarning() << "Failed to open the mouse interface.";
+            return 3;
+        }
+
+        qWarning() << "Measuring, keep moving the mouse...";
+        QEventLoop loop;
+        QTimer::singleShot(1000 * parser.value(analyzeRateOption).toInt(), &loop, SLOT(quit()));
+        loop.exec();
+        analyzer.stop();
+
+        QTextStream(stdout) << QJsonDocument(analyzer.toJson()).toJson();
+        return analyzer.count() > 0 ? 0 : 4;
+    }
+
+    if (parser.isSet(effectOption))
+    {
+        auto spec = parser.value(effectOption);
+        auto effect = LightingEffect::create(spec.section(':', 0, 0), spec.section(':', 1));
+        if (!effect)
+        {
+            qWarning() << "Unknown effect" << spec << "the supported ones are" << LightingEffect::names().join(", ");
+            return 2;
+        }
+
+        LightingEngine engine(&mice);
+        engine.setEffect(effect);
+        engine.setMaxFps(parser.value(effectFpsOption).toInt());
+
+        if (!engine.start())
+        {
+            qWarning() << "Failed to read the lighting settings.";
+            return 3;
+        }
+
+        QEventLoop loop;
+        QObject::connect(&engine, SIGNAL(failed()), &loop, SLOT(quit()));
+        auto seconds = parser.value(effectTimeOption).toInt();
+        if (seconds > 0)
+        {
+            QTimer::singleShot(1000 * seconds, &loop, SLOT(quit()));
+        }
+        loop.exec();
+        engine.stop();
+
+        QTextStream(stdout) << QJsonDocument(engine.toJson()).toJson();
+        return engine.writtenFrames() > 0 ? 0 : 4;
+    }
+
     if (parser.isSet(profileOption))
     {
         qWarning() << mice.profile();
@@ -153,6 +414,70 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    if (parser.isSet(buttonOption))
+    {
+        auto index = parser.value(buttonOption).toInt();
+        if (index < 1 || index > MS794::ButtonMinus + 1)
+        {
+            qWarning() << "The button index must be in range 1 ..." << MS794::ButtonMinus + 1;
+            return 2;
+        }
+
+        // -1 is the read failure. The bindings with a key above 0x7F are negative too, but never all ones.
+        auto value = mice.button(MS794::ButtonIndex(index - 1));
+        if (value == -1)
+        {
+            qWarning() << "Failed to read the buttons.";
+            return 3;
+        }
+
+        QTextStream(stdout) << ButtonBinding(value).toString() << '\n';
+        return 0;
+    }
+
+    if (parser.isSet(setButtonOption))
+    {
+        auto value = parser.value(setButtonOption);
+        auto index = value.section('=', 0, 0).toInt();
+        if (index < 1 || index > MS794::ButtonMinus + 1)
+        {
+            qWarning() << "The button index must be in range 1 ..." << MS794::ButtonMinus + 1;
+            return 2;
+        }
+
+        bool ok = false;
+        auto binding = ButtonBinding::fromString(value.section('=', 1), &ok);
+        if (!ok)
+        {
+            qWarning() << "Failed to parse the binding" << value.section('=', 1);
+            return 2;
+        }
+
+        if (!binding.isValid())
+        {
+            qWarning() << "The binding" << binding.toString() << "is not supported by the device.";
+            return 2;
+        }
+
+        auto btn = MS794::ButtonIndex(index - 1);
+        auto current = mice.button(btn);
+        if (current == -1)
+        {
+            // setButton() would do nothing, and save() would succeed
+            qWarning() << "Failed to read the buttons.";
+            return 3;
+        }
+
+        mice.setButton(btn, binding.withIndex(ButtonBinding(current).index()).value());
+        if (!mice.save())
+        {
+            qWarning() << "Failed to write the binding.";
+            return 3;
+        }
+
+        return 0;
+    }
+
     // Should never happen.
     qCritical() << "Unhandled options: " << parser.optionNames();
     return 0;
@@ -21,6 +21,9 @@
 #include "ms794.h"
 
 #include "buttonedit.h"
+#include "deviceprobe.h"
+#include "liveapplier.h"
+#include "pagediagnostics.h"
 #include "profileedit.h"
 #include "pagelight.h"
 #include "pagemacro.h"
@@ -28,8 +31,35 @@
 
 #include <qxtglobal.h>
 #include <QCloseEvent>
+#include <QDebug>
+#include <QElapsedTimer>
 #include <QMessageBox>
+#include <QProgressDialog>
+#include <QShortcut>
+#include <QSpinBox>
+#include <QStatusBar>
 #include <QStyle>
+#include <QTimer>
+
+// Push the edits into the device cache after a short pause in typing/dragging
+#define FLUSH_DELAY 250
+// Do not flash the progress for fast saves
+#define SAVE_PROGRESS_DELAY 300
+
+static QString pageName(int page)
+{
+    switch (page)
+    {
+    case MS794::PageLighting:
+        return MainWindow::tr("lighting");
+    case MS794::PageButtons:
+        return MainWindow::tr("buttons and macros");
+    case MS794::PageProfile:
+        return MainWindow::tr("profile and report rate");
+    }
+
+    return QString::number(page);
+}
 
 static void initAction(QAction *action, QStyle::StandardPixmap icon, QKeySequence::StandardKey key)
 {
@@ -42,17 +72,57 @@ MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , mice(new MS794(this))
+    , activeProfile(nullptr)
+    , flushTimer(new QTimer(this))
+    , liveApplier(new LiveApplier(mice, this))
+    , probe(new DeviceProbe(mice, this))
+    , saveProgress(nullptr)
+    , saveTotalBytes(0)
+    , saveWrittenBytes(0)
+    , saveFailedPage(0)
+    , pageDiagnostics(nullptr)
 {
+    startupTimer.start();
     ui->setupUi(this);
     // The Designer really lacs this functionality
     initAction(ui->actionExit, QStyle::SP_DialogCloseButton, QKeySequence::Quit);
     initAction(ui->actionSave, QStyle::SP_DialogSaveButton, QKeySequence::Save);
 
     ui->labelText->setText(ui->labelText->text().arg(PRODUCT_VERSION).arg(__DATE__));
-    connect(mice, SIGNAL(connectChanged(bool)), this, SLOT(onMiceConnected(bool)));
 
-    // Check the device availability
-    onMiceConnected(mice->ping());
+    for (int i = 0; i < ui->tabWidget->count(); ++i)
+    {
+        tabTitles << ui->tabWidget->tabText(i);
+    }
+
+    flushTimer->setSingleShot(true);
+    flushTimer->setInterval(FLUSH_DELAY);
+    connect(flushTimer, SIGNAL(timeout()), this, SLOT(onFlush()));
+
+    spinLiveWindow = new QSpinBox;
+    spinLiveWindow->setRange(LiveApplier::MinWindow, LiveApplier::MaxWindow);
+    spinLiveWindow->setSingleStep(10);
+    spinLiveWindow->setValue(liveApplier->window());
+    spinLiveWindow->setPrefix(tr("every  "));
+    spinLiveWindow->setSuffix(tr("  msec"));
+    spinLiveWindow->setToolTip(tr("Write the changes to the device at most this often"));
+    spinLiveWindow->setEnabled(false);
+    ui->mainToolBar->addWidget(spinLiveWindow);
+    connect(spinLiveWindow, SIGNAL(valueChanged(int)), liveApplier, SLOT(setWindow(int)));
+    connect(liveApplier, SIGNAL(applied(int)), this, SLOT(onLiveApplied(int)));
+    connect(liveApplier, SIGNAL(failed()), this, SLOT(onLiveApplyFailed()));
+    connect(mice, SIGNAL(connectChanged(bool)), this, SLOT(onMiceConnected(bool)));
+    connect(mice, SIGNAL(saveStarted(int, int)), this, SLOT(onSaveStarted(int, int)));
+    connect(mice, SIGNAL(pageSaving(int, int)), this, SLOT(onPageSaving(int, int)));
+    connect(mice, SIGNAL(pageSaved(int, int, bool)), this, SLOT(onPageSaved(int, int, bool)));
+    new QShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_D), this, SLOT(onToggleDiagnostics()));
+
+    // Check the device availability without blocking the window
+    onMiceConnected(false);
+    statusBar()->showMessage(tr("Connecting to the device..."));
+    connect(probe, SIGNAL(finished()), this, SLOT(onProbeFinished()));
+    mice->setArrivalsDeferred(true);
+    probe->start();
 }
 
 MainWindow::~MainWindow()
@@ -62,18 +132,19 @@ MainWindow::~MainWindow()
 
 void MainWindow::updateMice()
 {
-    foreach (auto edit, findChildren<ButtonEdit *>())
+    bool profilesChanged = false;
+    foreach (auto editor, MiceWidget::saveModified(editors, mice))
     {
-        mice->setButton((MS794::ButtonIndex)(edit->index() - 1), edit->value());
+        profilesChanged = profilesChanged || qobject_cast<ProfileEdit *>(editor);
     }
 
+    if (!profilesChanged)
+        return;
+
     int numProfiles = 0;
-    foreach (auto widget, findChildren<MiceWidget *>())
+    foreach (auto pe, profiles)
     {
-        widget->save(mice);
-
-        ProfileEdit * pe = qobject_cast<ProfileEdit *>(widget);
-        if (pe && pe->enabled())
+        if (pe->enabled())
         {
             ++numProfiles;
             if (pe->active())
@@ -89,25 +160,206 @@ void MainWindow::updateMice()
     }
 }
 
+void MainWindow::registerEditor(MiceWidget *editor, QWidget *tab)
+{
+    editors.push_back(editor);
+    editorTabs[editor] = tab;
+    connect(editor, SIGNAL(changed()), this, SLOT(onEditorChanged()));
+}
+
+void MainWindow::onEditorChanged()
+{
+    auto editor = static_cast<MiceWidget *>(sender());
+    modifiedTabs.insert(editorTabs[editor]);
+
+    if (liveApplier->isEnabled() && (qobject_cast<ProfileEdit *>(editor) || qobject_cast<PageLight *>(editor)))
+    {
+        // No need to wait, the applier coalesces the writes anyway.
+        flushTimer->stop();
+        updateMice();
+        liveApplier->apply();
+        return;
+    }
+
+    flushTimer->start();
+}
+
+void MainWindow::onLiveApplyToggled(bool enabled)
+{
+    liveApplier->setEnabled(enabled);
+    spinLiveWindow->setEnabled(enabled);
+
+    if (enabled)
+    {
+        // Write the pending changes, if any
+        flushTimer->stop();
+        updateMice();
+        liveApplier->apply();
+    }
+    else
+    {
+        statusBar()->clearMessage();
+    }
+}
+
+void MainWindow::onLiveApplied(int latency)
+{
+    updateTabTitles();
+    statusBar()->showMessage(tr("Applied in %1 msec (average %2, max %3 msec)")
+                                 .arg(latency)
+                                 .arg(liveApplier->meanLatency(), 0, 'f', 0)
+                                 .arg(liveApplier->maxLatency()));
+}
+
+void MainWindow::onLiveApplyFailed()
+{
+    // The changes are still pending, keep the tabs marked
+    updateTabTitles();
+    statusBar()->showMessage(tr("Failed to apply the changes to the device"));
+}
+
+void MainWindow::onFlush()
+{
+    updateMice();
+    updateTabTitles();
+}
+
+void MainWindow::updateTabTitles()
+{
+    // The edits may have been reverted, the device knows better.
+    if (!mice->unsavedChanges())
+        modifiedTabs.clear();
+
+    for (int i = 0; i < tabTitles.size(); ++i)
+    {
+        auto modified = modifiedTabs.find(ui->tabWidget->widget(i)) != modifiedTabs.end();
+        ui->tabWidget->setTabText(i, modified ? tabTitles[i] + " *" : tabTitles[i]);
+    }
+}
+
+void MainWindow::onProfileActivated()
+{
+    auto edit = static_cast<ProfileEdit *>(sender());
+
+    if (activeProfile && activeProfile != edit)
+        activeProfile->setActive(false);
+
+    activeProfile = edit;
+}
+
 void MainWindow::onSave()
 {
+    // The cache is up to date except for the very last edits, so this is mostly a page flush.
+    flushTimer->stop();
     updateMice();
 
-    if (!mice->save())
+    saveMice();
+    updateTabTitles();
+}
+
+bool MainWindow::saveMice()
+{
+    QProgressDialog progress(tr("Saving..."), tr("Cancel"), 0, 1, this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(SAVE_PROGRESS_DELAY);
+    connect(&progress, SIGNAL(canceled()), mice, SLOT(cancelSave()));
+
+    saveProgress = &progress;
+    saveTimer.start();
+    saveTotalBytes = saveWrittenBytes = saveFailedPage = 0;
+    auto ok = mice->save();
+    saveProgress = nullptr;
+
+    if (ok)
     {
-        QMessageBox::warning(this, windowTitle(), tr("Failed to save"));
+        if (saveTotalBytes > 0)
+        {
+            statusBar()->showMessage(tr("Saved %1 bytes in %2 msec").arg(saveTotalBytes).arg(saveTimer.elapsed()));
+        }
+    }
+    else if (saveFailedPage)
+    {
+        QMessageBox::warning(this, windowTitle(),
+            tr("Failed to write the %1 page.\n%2 of %3 bytes were written in %4 msec.")
+                .arg(pageName(saveFailedPage))
+                .arg(saveWrittenBytes)
+                .arg(saveTotalBytes)
+                .arg(saveTimer.elapsed()));
     }
+    else
+    {
+        statusBar()->showMessage(
+            tr("Save cancelled, %1 of %2 bytes were written").arg(saveWrittenBytes).arg(saveTotalBytes));
+    }
+
+    return ok;
+}
+
+void MainWindow::onSaveStarted(int, int bytes)
+{
+    saveTotalBytes = bytes;
+    if (saveProgress)
+    {
+        saveProgress->setMaximum(qMax(1, bytes));
+    }
+}
+
+void MainWindow::onPageSaving(int page, int bytes)
+{
+    if (saveProgress)
+    {
+        saveProgress->setLabelText(tr("Writing the %1 page, %2 bytes...\n%3 of %4 bytes written in %5 msec")
+                                       .arg(pageName(page))
+                                       .arg(bytes)
+                                       .arg(saveWrittenBytes)
+                                       .arg(saveTotalBytes)
+                                       .arg(saveTimer.elapsed()));
+    }
+}
+
+void MainWindow::onPageSaved(int page, int bytes, bool ok)
+{
+    if (!ok)
+    {
+        saveFailedPage = page;
+        return;
+    }
+
+    saveWrittenBytes += bytes;
+    if (saveProgress)
+    {
+        // A modal progress processes the events here, so Cancel works between the pages.
+        saveProgress->setValue(saveWrittenBytes);
+    }
+}
+
+void MainWindow::onProbeFinished()
+{
+    probe->wait();
+    qDebug() << "The device probe took" << probe->duration() << "msec, connected:" << probe->isConnected();
+
+    statusBar()->showMessage(probe->isConnected() ? tr("Connected") : tr("The device was not found"), 3000);
+    onMiceConnected(probe->isConnected());
+
+    // A replug during the probe is handled only now, from this thread.
+    mice->setArrivalsDeferred(false);
 }
 
 void MainWindow::onMiceConnected(bool connected)
 {
+    if (probe->isRunning())
+    {
+        // The probe will tell
+        return;
+    }
+
     auto aboutIndex = ui->tabWidget->indexOf(ui->pageAbout);
     if (!connected)
         ui->tabWidget->setCurrentIndex(aboutIndex);
 
     for (int i = 0; i < ui->tabWidget->count(); ++i)
     {
-        if (aboutIndex == i)
+        if (aboutIndex == i || ui->tabWidget->widget(i) == pageDiagnostics)
             continue;
         ui->tabWidget->setTabEnabled(i, connected);
     }
@@ -126,44 +378,57 @@ std::pair<QString, MS794::ButtonIndex> mainButtons[] =
     {QCoreApplication::translate("button", "Button &Minus"),   MS794::ButtonMinus},
 };
 
-static bool prepareButtonsPage(
-    QWidget *parent, MS794 *mice, const std::pair<QString, MS794::ButtonIndex> *buttons, size_t numButtons)
+bool MainWindow::prepareButtonsPage(
+    QWidget *parent, const std::pair<QString, MS794::ButtonIndex> *buttons, size_t numButtons)
 {
     auto layout = new QVBoxLayout;
+    std::vector<ButtonEdit *> edits;
 
     for (size_t i = 0; i < numButtons; ++i)
     {
-        auto value = mice->button(buttons[i].second);
-        if (value == -1)
+        auto edit = new ButtonEdit(buttons[i].first, buttons[i].second);
+        if (!edit->load(mice))
         {
+            qDeleteAll(edits);
+            delete edit;
             delete layout;
             return false;
         }
-        auto edit = new ButtonEdit(buttons[i].first);
-        edit->setValue(value);
         layout->addWidget(edit);
+        edits.push_back(edit);
     }
 
     layout->addStretch();
     parent->setLayout(layout);
+
+    foreach (auto edit, edits)
+    {
+        registerEditor(edit, parent);
+    }
     return true;
 }
 
-static bool prepareProfilesPage(QWidget *parent, MS794 *mice)
+bool MainWindow::prepareProfilesPage(QWidget *parent)
 {
-    int activeProfile = mice->profile();
-    if (activeProfile < 0)
+    int activeIndex = mice->profile();
+    if (activeIndex < 0)
         return false;
 
     auto layout = new QVBoxLayout;
     layout->setMargin(0);
 
+    std::vector<ProfileEdit *> edits;
     int enabledProfiles = 0;
+    QElapsedTimer timer;
+    qint64 constructionTime = 0;
     for (int i = 0; i < MS794::MaxProfile; ++i)
     {
+        timer.start();
         auto edit = new ProfileEdit(i);
+        constructionTime += timer.nsecsElapsed();
         if (!edit->load(mice))
         {
+            qDeleteAll(edits);
             delete edit;
             delete layout;
             return false;
@@ -173,12 +438,25 @@ static bool prepareProfilesPage(QWidget *parent, MS794 *mice)
         {
             ++enabledProfiles;
         }
-        edit->setActive(enabledProfiles == activeProfile);
+        edit->setActive(enabledProfiles == activeIndex);
+        edit->setModified(false);
         layout->addWidget(edit);
+        edits.push_back(edit);
     }
 
     layout->addStretch();
     parent->setLayout(layout);
+    qDebug() << "The profile editors were created in" << constructionTime / 1000 << "usec";
+
+    foreach (auto edit, edits)
+    {
+        if (edit->active())
+            activeProfile = edit;
+
+        connect(edit, SIGNAL(activated()), this, SLOT(onProfileActivated()));
+        profiles.push_back(edit);
+        registerEditor(edit, parent);
+    }
     return true;
 }
 
@@ -193,6 +471,7 @@ bool MainWindow::initPage(QWidget *parent, MiceWidget *page)
     auto layout = new QVBoxLayout;
     parent->setLayout(layout);
     layout->addWidget(page);
+    registerEditor(page, parent);
     return true;
 }
 
@@ -208,13 +487,13 @@ void MainWindow::onPreparePage(int idx)
 
     bool ok = true;
     if (page == ui->pageMainButtons)
-        ok = prepareButtonsPage(page, mice, mainButtons, _countof(mainButtons));
+        ok = prepareButtonsPage(page, mainButtons, _countof(mainButtons));
     else if (page == ui->pageMacros)
         ok = initPage(page, new PageMacro());
     else if (page == ui->pageRate)
         ok = initPage(page, new PageRate());
     else if (page == ui->pageProfiles)
-        ok = prepareProfilesPage(page, mice);
+        ok = prepareProfilesPage(page);
     else if (page == ui->pageLight)
         ok = initPage(page, new PageLight());
 
@@ -224,17 +503,30 @@ void MainWindow::onPreparePage(int idx)
     }
 }
 
+void MainWindow::showEvent(QShowEvent *evt)
+{
+    if (startupTimer.isValid())
+    {
+        qDebug() << "The window is shown in" << startupTimer.elapsed() << "msec";
+        startupTimer.invalidate();
+    }
+
+    QMainWindow::showEvent(evt);
+}
+
 void MainWindow::closeEvent(QCloseEvent *evt)
 {
+    // The probe owns the device until it finishes
+    probe->wait();
+    flushTimer->stop();
     updateMice();
 
     if (mice->unsavedChanges()
         && QMessageBox::question(this, windowTitle(), tr("You have unsaved changes.\nSave them now?"))
                == QMessageBox::Yes)
     {
-        if (!mice->save())
+        if (!saveMice())
         {
-            QMessageBox::warning(this, windowTitle(), tr("Failed to save"));
             evt->ignore();
             return;
         }
@@ -242,3 +534,17 @@ void MainWindow::closeEvent(QCloseEvent *evt)
 
     QMainWindow::closeEvent(evt);
 }
+
+void MainWindow::onToggleDiagnostics()
+{
+    if (pageDiagnostics)
+    {
+        delete pageDiagnostics;
+        pageDiagnostics = nullptr;
+        return;
+    }
+
+    pageDiagnostics = new PageDiagnostics;
+    ui->tabWidget->addTab(pageDiagnostics, tr("Diagnostics"));
+    ui->tabWidget->setCurrentWidget(pageDiagnostics);
+}
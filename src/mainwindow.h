@@ -19,7 +19,13 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include "ms794.h"
+
+#include <QElapsedTimer>
 #include <QMainWindow>
+#include <QStringList>
+#include <map>
+#include <set>
 
 QT_FORWARD_DECLARE_CLASS(QVBoxLayout)
 namespace Ui
@@ -36,6 +42,7 @@ public:
 
 protected:
     void closeEvent(QCloseEvent *evt);
+    void showEvent(QShowEvent *evt);
 
 public slots:
     void onSave();
@@ -43,13 +50,57 @@ public slots:
 
 private slots:
     void onPreparePage(int idx);
+    void onProfileActivated();
+    void onEditorChanged();
+    void onFlush();
+    void onLiveApplyToggled(bool enabled);
+    void onLiveApplied(int latency);
+    void onLiveApplyFailed();
+    void onProbeFinished();
+    void onSaveStarted(int pages, int bytes);
+    void onPageSaving(int page, int bytes);
+    void onPageSaved(int page, int bytes, bool ok);
+    void onToggleDiagnostics();
 
 private:
     void updateMice();
+    bool saveMice();
+    void updateTabTitles();
+    void registerEditor(class MiceWidget *editor, QWidget *tab);
     bool initPage(QWidget *parent, class MiceWidget *page);
+    bool prepareButtonsPage(QWidget *parent, const std::pair<QString, MS794::ButtonIndex> *buttons, size_t numButtons);
+    bool prepareProfilesPage(QWidget *parent);
 
     Ui::MainWindow *ui;
     class MS794 *mice;
+
+    // All the editors of the prepared pages
+    std::vector<class MiceWidget *> editors;
+    std::vector<class ProfileEdit *> profiles;
+    class ProfileEdit *activeProfile;
+
+    // Edits are pushed into the device cache with a delay
+    class QTimer *flushTimer;
+    std::map<class MiceWidget *, QWidget *> editorTabs;
+    std::set<QWidget *> modifiedTabs;
+    QStringList tabTitles;
+
+    class LiveApplier *liveApplier;
+    class QSpinBox *spinLiveWindow;
+
+    // The device is probed in background while the window is already shown
+    class DeviceProbe *probe;
+    QElapsedTimer startupTimer;
+
+    // Hidden by default
+    class PageDiagnostics *pageDiagnostics;
+
+    // The save progress, valid during saveMice() only
+    class QProgressDialog *saveProgress;
+    QElapsedTimer saveTimer;
+    int saveTotalBytes;
+    int saveWrittenBytes;
+    int saveFailedPage;
 };
 
 #endif // MAINWINDOW_H
@@ -20,6 +20,7 @@
 #define MICEWIDGET_H
 
 #include <QWidget>
+#include <vector>
 
 class MiceWidget : public QWidget
 {
@@ -28,11 +29,54 @@ class MiceWidget : public QWidget
 public:
     explicit MiceWidget(QWidget *parent = 0)
         : QWidget(parent)
+        , modified(false)
     {
     }
 
     virtual bool load(class MS794 *) = 0;
     virtual void save(class MS794 *) = 0;
+
+    // Whether the widget was edited since it was loaded or saved last time.
+    bool isModified() const
+    {
+        return modified;
+    }
+
+    void setModified(bool value)
+    {
+        modified = value;
+    }
+
+    // Saves the modified editors only. Returns the editors that were saved.
+    static std::vector<MiceWidget *> saveModified(const std::vector<MiceWidget *> &editors, class MS794 *mice)
+    {
+        std::vector<MiceWidget *> saved;
+        for (auto editor : editors)
+        {
+            if (!editor->modified)
+                continue;
+
+            editor->save(mice);
+            editor->modified = false;
+            saved.push_back(editor);
+        }
+
+        return saved;
+    }
+
+signals:
+    // Emitted on every edit.
+    void changed();
+
+protected slots:
+    void markModified()
+    {
+        modified = true;
+        emit changed();
+    }
+
+private:
+    bool modified;
 };
 
 #endif // MICEWIDGET_H
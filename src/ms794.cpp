@@ -18,6 +18,7 @@
 
 #include "ms794.h"
 #include "qhiddevice.h"
+#include "qhidflightrecorder.h"
 #include "qhidmonitor.h"
 
 #include <QRgb>
@@ -26,6 +27,8 @@
 #define PRODUCT 0x1007
 #define KEYBOARD_USAGE_PAGE 7
 #define KEYBOARD_USAGE      6
+#define MOUSE_USAGE_PAGE    1
+#define MOUSE_USAGE         2
 
 Q_LOGGING_CATEGORY(UsbIo, "usb")
 
@@ -34,10 +37,24 @@ Q_LOGGING_CATEGORY(UsbIo, "usb")
 #define qCInfo qCWarning
 #endif
 
+// ping() runs on every arrival, while the device may still be settling, so it gives up quickly.
+static const QHIDIoPolicy pingPolicy(300, 4, 5, 50);
+
+// Saves the last device transactions for the post mortem.
+static void dumpDeviceIo(const QString &reason)
+{
+    auto path = QHIDFlightRecorder::defaultDumpPath();
+    if (QHIDFlightRecorder::dump(path, reason))
+        qCWarning(UsbIo) << reason << "- the last device transactions were saved to" << path;
+}
+
 MS794::MS794(QObject *parent)
     : QObject(parent)
-    , device(new QHIDDevice(VENDOR, PRODUCT, KEYBOARD_USAGE_PAGE, KEYBOARD_USAGE, this))
+    , device(new QHIDDevice(this))
     , monitor(new QHIDMonitor(VENDOR, PRODUCT, this))
+    , saveCancelled(false)
+    , arrivalsDeferred(false)
+    , arrivalPending(false)
 {
     connect(monitor, SIGNAL(deviceArrival(QString)), this, SLOT(deviceArrival(QString)));
     connect(monitor, SIGNAL(deviceRemove()), this, SLOT(deviceRemove()));
@@ -54,7 +71,25 @@ MS794::~MS794()
 void MS794::deviceArrival(const QString &path)
 {
     qCInfo(UsbIo) << "Detected device arrival at" << path;
-    auto connected = device->open(VENDOR, PRODUCT, KEYBOARD_USAGE_PAGE, KEYBOARD_USAGE) && ping();
+    if (arrivalsDeferred)
+    {
+        arrivalPending = true;
+        return;
+    }
+
+    auto connected = open() && ping();
+    connectChanged(connected);
+}
+
+void MS794::setArrivalsDeferred(bool value)
+{
+    arrivalsDeferred = value;
+    if (value || !arrivalPending)
+        return;
+
+    // The device may have been replugged meanwhile, so open it again.
+    arrivalPending = false;
+    auto connected = open() && ping();
     connectChanged(connected);
 }
 
@@ -80,6 +115,11 @@ int MS794::getPageSize(Page page)
 }
 
 char *MS794::readPage(Page page)
+{
+    return readPage(page, device->ioPolicy());
+}
+
+char *MS794::readPage(Page page, const QHIDIoPolicy &policy)
 {
     auto iter = cache.find(page);
 
@@ -91,19 +131,33 @@ char *MS794::readPage(Page page)
     Q_CHECK_PTR(value);
 
     value[0] = (char)page;
-    auto read = device->getFeatureReport(value, pageSize);
+    auto read = device->getFeatureReport(value, pageSize, policy);
 
     if (read != pageSize || value[0] != (char)page)
     {
         qCWarning(UsbIo) << "readPage: invalid response:" << read;
+        delete[] value;
         return nullptr;
     }
     qCDebug(UsbIo) << "readPage" << page << QByteArray(value, pageSize).toHex();
 
     dirtyPages[page] = false;
+    savedPages[page] = QByteArray(value, pageSize);
     return cache[page] = value;
 }
 
+bool MS794::pageModified(Page page)
+{
+    if (!dirtyPages[page])
+        return false;
+
+    // The page may be edited back to the saved state.
+    auto saved = savedPages.find(page);
+    auto iter = cache.find(page);
+    return saved == savedPages.end() || iter == cache.end()
+        || memcmp(iter->second, saved->second.constData(), size_t(saved->second.size())) != 0;
+}
+
 bool MS794::writePage(const char *data, Page cmd)
 {
     auto pageSize = getPageSize(cmd);
@@ -342,30 +396,114 @@ void MS794::blink(bool value)
     writeByte(PageProfile, BlinkOffset, value ? 2 : 1);
 }
 
+bool MS794::open()
+{
+    return device->open(VENDOR, PRODUCT, KEYBOARD_USAGE_PAGE, KEYBOARD_USAGE);
+}
+
 bool MS794::ping()
 {
-    return readPage(PageProfile) != nullptr;
+    // The device is opened on the first use, that may take a while.
+    if (!device->isValid() && !open())
+        return false;
+
+    if (!readPage(PageProfile, pingPolicy))
+    {
+        dumpDeviceIo("ping failed");
+        return false;
+    }
+
+    return true;
+}
+
+bool MS794::prefetch()
+{
+    return ping() && readPage(PageLighting) && readPage(PageButtons);
+}
+
+QHIDDevice *MS794::hidDevice() const
+{
+    return device;
+}
+
+QHIDDevice *MS794::openMouseInterface(QObject *parent)
+{
+    return new QHIDDevice(VENDOR, PRODUCT, MOUSE_USAGE_PAGE, MOUSE_USAGE, parent);
 }
 
 bool MS794::unsavedChanges()
 {
-    return dirtyPages.cend() != std::find_if(dirtyPages.cbegin(), dirtyPages.cend(),
-                                    [](const std::map<int, bool>::value_type &x) { return x.second; });
+    foreach (auto page, cache)
+    {
+        if (pageModified(page.first))
+            return true;
+    }
+
+    return false;
 }
 
 bool MS794::save()
 {
+    std::vector<Page> pages;
+    int bytes = 0;
+
     foreach (auto page, cache)
     {
-        if (!dirtyPages[page.first])
-            continue;
-
-        if (writePage(page.second, page.first))
-            dirtyPages[page.first] = false;
+        if (pageModified(page.first))
+        {
+            pages.push_back(page.first);
+            bytes += getPageSize(page.first);
+        }
         else
+        {
+            // Edited back to the saved state
+            dirtyPages[page.first] = false;
+        }
+    }
+
+    saveCancelled = false;
+    emit saveStarted(int(pages.size()), bytes);
+
+    foreach (auto page, pages)
+    {
+        // The receivers may process the events, so the cancel comes in between.
+        if (saveCancelled)
+            return false;
+
+        emit pageSaving(page, getPageSize(page));
+        auto ok = save(page);
+        emit pageSaved(page, getPageSize(page), ok);
+
+        if (!ok)
+            return false;
+    }
+
+    return true;
+}
+
+void MS794::cancelSave()
+{
+    saveCancelled = true;
+}
+
+bool MS794::save(Page page)
+{
+    auto iter = cache.find(page);
+    if (iter == cache.end())
+        return true;
+
+    if (pageModified(page))
+    {
+        if (!writePage(iter->second, page))
+        {
+            dumpDeviceIo(QString("save failed on page %1").arg(page));
             return false;
+        }
+
+        savedPages[page] = QByteArray(iter->second, getPageSize(page));
     }
 
+    dirtyPages[page] = false;
     return true;
 }
 
@@ -400,8 +538,14 @@ bool MS794::restoreConfig(QIODevice *storage)
     foreach (const auto& cmd, cmds)
     {
         auto page = storage->read(getPageSize(cmd));
-        if (page.at(0) != cmd || !writePage(page.cbegin(), cmd))
+        if (page.at(0) != cmd)
             return false;
+
+        if (!writePage(page.cbegin(), cmd))
+        {
+            dumpDeviceIo(QString("restore failed on page %1").arg(cmd));
+            return false;
+        }
     }
 
     return true;
@@ -35,6 +35,7 @@ class MS794 : public QObject
 
     Q_OBJECT
 
+public:
     enum Page
     {
         PageLighting = 4, // 59 bytes
@@ -42,7 +43,6 @@ class MS794 : public QObject
         PageProfile = 8, // 9 bytes
     };
 
-public:
     enum Constants
     {
         MaxMacroNum = 8,
@@ -138,7 +138,10 @@ public:
     void setLightValue(int value);
 
     bool unsavedChanges();
+    // Writes all the modified pages, reports the progress with the signals below.
     bool save();
+    // Writes the page if it has unsaved changes.
+    bool save(Page page);
 
     int lightColor(int index);
     void setLightColor(int index, int value);
@@ -159,12 +162,28 @@ public:
     void setMacro(int index, const QByteArray &value);
 
     void blink(bool value);
+    bool open();
     bool ping();
+    // Reads all the pages into the cache.
+    bool prefetch();
+    // While set, the arrivals are only remembered and handled once it is cleared,
+    // so a thread that owns the device (see DeviceProbe) is never raced by the GUI one.
+    void setArrivalsDeferred(bool value);
+    class QHIDDevice *hidDevice() const;
+    static class QHIDDevice *openMouseInterface(QObject *parent = 0);
     bool backupConfig(class QIODevice *storage);
     bool restoreConfig(class QIODevice *storage);
 
 signals:
     void connectChanged(bool connected);
+    // save() is about to write that many pages & bytes
+    void saveStarted(int pages, int bytes);
+    void pageSaving(int page, int bytes);
+    void pageSaved(int page, int bytes, bool ok);
+
+public slots:
+    // Stops save() before the next page, the current one is written anyway.
+    void cancelSave();
 
 private slots:
     void deviceArrival(const QString &path);
@@ -195,7 +214,9 @@ private:
     };
 
     char *readPage(Page page);
+    char *readPage(Page page, const struct QHIDIoPolicy &policy);
     bool writePage(const char *data, Page cmd);
+    bool pageModified(Page page);
 
     int readByte(Page page, int offset);
     void writeByte(Page page, int offset, int value);
@@ -207,6 +228,11 @@ private:
 
     std::map<Page, char *> cache;
     std::map<Page, bool> dirtyPages;
+    // The pages as they are on the device
+    std::map<Page, QByteArray> savedPages;
+    bool saveCancelled;
+    bool arrivalsDeferred;
+    bool arrivalPending;
 };
 
 #endif // MS794_H
@@ -0,0 +1,80 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "pagediagnostics.h"
+#include "qhidstats.h"
+
+#include <QHBoxLayout>
+#include <QJsonDocument>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QTimer>
+#include <QVBoxLayout>
+
+// Refresh rate of the visible page, msec
+#define REFRESH_INTERVAL 1000
+
+PageDiagnostics::PageDiagnostics(QWidget *parent)
+    : QWidget(parent)
+    , text(new QPlainTextEdit)
+    , timer(new QTimer(this))
+{
+    text->setReadOnly(true);
+    text->setFont(QFont("Monospace"));
+
+    auto btnReset = new QPushButton(tr("&Reset"));
+    connect(btnReset, SIGNAL(clicked()), this, SLOT(reset()));
+
+    auto buttons = new QHBoxLayout;
+    buttons->addStretch();
+    buttons->addWidget(btnReset);
+
+    auto layout = new QVBoxLayout;
+    layout->addWidget(text);
+    layout->addLayout(buttons);
+    setLayout(layout);
+
+    timer->setInterval(REFRESH_INTERVAL);
+    connect(timer, SIGNAL(timeout()), this, SLOT(refresh()));
+}
+
+void PageDiagnostics::showEvent(QShowEvent *)
+{
+    refresh();
+    timer->start();
+}
+
+void PageDiagnostics::hideEvent(QHideEvent *)
+{
+    timer->stop();
+}
+
+void PageDiagnostics::refresh()
+{
+    // Keep the scroll position
+    auto pos = text->verticalScrollBar()->value();
+    text->setPlainText(QJsonDocument(QHIDStats::toJson()).toJson());
+    text->verticalScrollBar()->setValue(pos);
+}
+
+void PageDiagnostics::reset()
+{
+    QHIDStats::reset();
+    refresh();
+}
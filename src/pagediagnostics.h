@@ -0,0 +1,48 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef PAGEDIAGNOSTICS_H
+#define PAGEDIAGNOSTICS_H
+
+#include <QWidget>
+
+QT_FORWARD_DECLARE_CLASS(QPlainTextEdit)
+QT_FORWARD_DECLARE_CLASS(QTimer)
+
+// The device I/O statistics for the troubleshooting. The tab is hidden, Ctrl+Shift+D shows it.
+class PageDiagnostics : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit PageDiagnostics(QWidget *parent = 0);
+
+protected:
+    void showEvent(QShowEvent *);
+    void hideEvent(QHideEvent *);
+
+private slots:
+    void refresh();
+    void reset();
+
+private:
+    QPlainTextEdit *text;
+    QTimer *timer;
+};
+
+#endif // PAGEDIAGNOSTICS_H
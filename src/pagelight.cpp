@@ -19,6 +19,7 @@
 #include "pagelight.h"
 #include "ui_pagelight.h"
 #include "colorbutton.h"
+#include "lightpreview.h"
 #include "ms794.h"
 
 #include <QCheckBox>
@@ -26,8 +27,10 @@
 PageLight::PageLight(QWidget *parent)
     : MiceWidget(parent)
     , ui(new Ui::PageLight)
+    , preview(new LightPreview)
 {
     ui->setupUi(this);
+    ui->layout->insertRow(0, tr("Preview"), preview);
 
     ui->cbDirection->addItems(QStringList() << tr("Up") << tr("Down"));
 
@@ -38,6 +41,18 @@ PageLight::PageLight(QWidget *parent)
         ui->layout->addRow(chk, btn);
         colorLabels.push_back(chk);
         buttons.push_back(btn);
+        connect(btn, SIGNAL(valueChanged(int)), this, SLOT(markModified()));
+        connect(chk, SIGNAL(toggled(bool)), this, SLOT(markModified()));
+        btn->hide();
+        chk->hide();
+    }
+
+    // Only the widgets of the current type are visible
+    QWidget *typeWidgets[] = {ui->labelDirection, ui->cbDirection, ui->labelValue, ui->sliderValue,
+        ui->labelRandomColor, ui->checkRandomColor};
+    for (auto widget : typeWidgets)
+    {
+        widget->hide();
     }
 
     ui->cbType->addItems(QStringList()
@@ -54,6 +69,12 @@ PageLight::PageLight(QWidget *parent)
                          << tr("Wave")
                          << tr("Trailing")
                          );
+
+    connect(ui->cbType, SIGNAL(currentIndexChanged(int)), this, SLOT(markModified()));
+    connect(ui->cbDirection, SIGNAL(currentIndexChanged(int)), this, SLOT(markModified()));
+    connect(ui->sliderValue, SIGNAL(valueChanged(int)), this, SLOT(markModified()));
+    connect(ui->checkRandomColor, SIGNAL(toggled(bool)), this, SLOT(markModified()));
+    connect(this, SIGNAL(changed()), this, SLOT(updatePreview()));
 }
 
 PageLight::~PageLight()
@@ -100,46 +121,60 @@ bool PageLight::load(MS794 *mice)
     }
 
     onLightTypeChanged(type);
+    updatePreview();
+    setModified(false);
     return true;
 }
 
 void PageLight::save(MS794 *mice)
 {
-    auto type = ui->cbType->currentIndex();
-    auto speed = ui->sliderValue->value();
-    auto value = 0;
+    int colors[MS794::MaxLightColor];
+    int numColors = 0;
+    auto value = currentValue(colors, &numColors);
 
-    if (type == MS794::LightColorfulStreaming || type == MS794::LightStreaming)
-    {
-        value = ui->cbDirection->currentIndex() > 0 ? 0 : 0x80;
-    }
-    else if (type == MS794::LightResponse && ui->checkRandomColor->isChecked())
-    {
-        value = 0x80;
-    }
-    else
+    for (int i = 0; i < numColors; ++i)
     {
-        for (int i = 0; i < MS794::MaxLightColor; ++i)
-        {
-            if (colorLabels[i]->isChecked())
-            {
-                mice->setLightColor(value, buttons[i]->value());
-                ++value;
-            }
-        }
+        mice->setLightColor(i, colors[i]);
     }
 
-    mice->setLightType(type << 4 | speed);
+    mice->setLightType(ui->cbType->currentIndex() << 4 | ui->sliderValue->value());
     mice->setLightValue(value);
 }
 
-void PageLight::onRandomColorToggled(bool value)
+// Returns the light value for the selected type and fills the enabled colors.
+int PageLight::currentValue(int *colors, int *numColors) const
 {
+    auto type = ui->cbType->currentIndex();
+    *numColors = 0;
+
+    if (type == MS794::LightColorfulStreaming || type == MS794::LightStreaming)
+        return ui->cbDirection->currentIndex() > 0 ? 0 : 0x80;
+
+    if (type == MS794::LightResponse && ui->checkRandomColor->isChecked())
+        return 0x80;
+
     for (int i = 0; i < MS794::MaxLightColor; ++i)
     {
-        buttons[i]->setHidden(value);
-        colorLabels[i]->setHidden(value);
+        if (colorLabels[i]->isChecked())
+            colors[(*numColors)++] = buttons[i]->value();
     }
+
+    return *numColors;
+}
+
+void PageLight::updatePreview()
+{
+    int colors[MS794::MaxLightColor];
+    int numColors = 0;
+    auto value = currentValue(colors, &numColors);
+
+    preview->setMode(ui->cbType->currentIndex() << 4 | ui->sliderValue->value(), value, colors, numColors);
+}
+
+void PageLight::onRandomColorToggled(bool)
+{
+    // Shows or hides the colors
+    onLightTypeChanged(ui->cbType->currentIndex());
 }
 
 void PageLight::onLightTypeChanged(int value)
@@ -154,8 +189,8 @@ void PageLight::onLightTypeChanged(int value)
 
     if (value == MS794::LightResponse)
     {
-        ui->labelRandomColor->show();
-        ui->checkRandomColor->show();
+        showWidget(ui->labelRandomColor);
+        showWidget(ui->checkRandomColor);
         if (ui->checkRandomColor->isChecked())
         {
             numColors = 0;
@@ -164,33 +199,38 @@ void PageLight::onLightTypeChanged(int value)
 
     for (int i = 0; i < numColors; ++i)
     {
-        buttons[i]->show();
-        colorLabels[i]->show();
+        showWidget(buttons[i]);
+        showWidget(colorLabels[i]);
     }
 
     if (value == MS794::LightColorfulStreaming || value == MS794::LightStreaming)
     {
-        ui->labelDirection->show();
-        ui->cbDirection->show();
+        showWidget(ui->labelDirection);
+        showWidget(ui->cbDirection);
     }
 
     if (value != MS794::LightOff && value != MS794::LightFliker
         && value != MS794::LightColorfulSteady)
     {
         ui->labelValue->setText(value == MS794::LightSteady ? tr("Brightn&ess") : tr("&Speed"));
-        ui->labelValue->show();
+        showWidget(ui->labelValue);
         ui->sliderValue->setMaximum(value == MS794::LightSteady ? 10 : 3);
-        ui->sliderValue->show();
+        showWidget(ui->sliderValue);
     }
 }
 
 void PageLight::hideWidgets()
 {
-    foreach (auto widget, findChildren<QWidget *>(QString(), Qt::FindDirectChildrenOnly))
+    foreach (auto widget, visibleWidgets)
     {
-        if (widget == ui->labelType || widget == ui->cbType)
-            continue;
-
         widget->hide();
     }
+
+    visibleWidgets.clear();
+}
+
+void PageLight::showWidget(QWidget *widget)
+{
+    widget->show();
+    visibleWidgets.push_back(widget);
 }
@@ -41,13 +41,18 @@ public:
 private slots:
     void onLightTypeChanged(int value);
     void onRandomColorToggled(bool value);
+    void updatePreview();
 
 private:
     Ui::PageLight *ui;
+    class LightPreview *preview;
     std::vector<class ColorButton *> buttons;
     std::vector<QCheckBox *> colorLabels;
+    std::vector<QWidget *> visibleWidgets;
 
+    int currentValue(int *colors, int *numColors) const;
     void hideWidgets();
+    void showWidget(QWidget *widget);
 };
 
 #endif // PAGELIGHT_H
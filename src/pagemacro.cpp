@@ -19,28 +19,46 @@
 #include "pagemacro.h"
 #include "ui_pagemacro.h"
 
-#include "macroedit.h"
+#include "macrodelegate.h"
+#include "macromodel.h"
+#include "macrorecorder.h"
 #include "ms794.h"
 
 #include <QMessageBox>
-
-#define EXTRA_DELAY 3
+#include <QStyle>
 
 PageMacro::PageMacro(QWidget *parent)
     : MiceWidget(parent)
     , ui(new Ui::PageMacro)
     , mice(nullptr)
+    , model(new MacroModel(this))
+    , recorder(new MacroRecorder(this))
 {
     ui->setupUi(this);
 
     auto cb = ui->cbAddAction;
     cb->addItem(tr("<add action>"));
-    cb->addItem(tr("Key Press"), MacroEdit::ActionKeyPress);
-    cb->addItem(tr("Key Down"), MacroEdit::ActionKeyDown);
-    cb->addItem(tr("Key Up"), MacroEdit::ActionKeyUp);
-    cb->addItem(tr("Button Click"), MacroEdit::ActionButtonClick);
-    cb->addItem(tr("Button Down"), MacroEdit::ActionButtonDown);
-    cb->addItem(tr("Button Up"), MacroEdit::ActionButtonUp);
+    auto types = {MacroAction::ActionKeyPress, MacroAction::ActionKeyDown, MacroAction::ActionKeyUp,
+        MacroAction::ActionButtonClick, MacroAction::ActionButtonDown, MacroAction::ActionButtonUp};
+    foreach (auto type, types)
+    {
+        cb->addItem(MacroModel::actionName(type), type);
+    }
+
+    ui->listActions->setModel(model);
+    ui->listActions->setItemDelegate(new MacroDelegate(this));
+    ui->btnMoveDown->setIcon(style()->standardIcon(QStyle::SP_ArrowDown));
+    ui->btnMoveUp->setIcon(style()->standardIcon(QStyle::SP_ArrowUp));
+    ui->btnRemove->setIcon(style()->standardIcon(QStyle::SP_DialogDiscardButton));
+    connect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)), this, SLOT(onActionsChanged()));
+    connect(model, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(onActionsChanged()));
+    connect(model, SIGNAL(rowsRemoved(QModelIndex, int, int)), this, SLOT(onActionsChanged()));
+    connect(model, SIGNAL(modelReset()), this, SLOT(onActionsChanged()));
+    connect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)), this, SLOT(markModified()));
+    connect(model, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(markModified()));
+    connect(model, SIGNAL(rowsRemoved(QModelIndex, int, int)), this, SLOT(markModified()));
+    connect(model, SIGNAL(rowsMoved(QModelIndex, int, int, QModelIndex, int)), this, SLOT(markModified()));
+    connect(ui->repeat, SIGNAL(valueChanged(int)), this, SLOT(markModified()));
 
     for (int i = 1; i <= MS794::MaxMacroNum; ++i)
     {
@@ -48,10 +66,15 @@ PageMacro::PageMacro(QWidget *parent)
         item->setData(QListWidgetItem::UserType, i);
         ui->listMacroIndex->addItem(item);
     }
+
+    ui->cbRecordDevice->addItems(MacroRecorder::inputDevices());
+    connect(recorder, SIGNAL(sizeChanged(int)), this, SLOT(onRecordSizeChanged(int)));
+    connect(recorder, SIGNAL(finished()), this, SLOT(onRecordFinished()));
 }
 
 PageMacro::~PageMacro()
 {
+    recorder->close();
     delete ui;
 }
 
@@ -66,6 +89,7 @@ bool PageMacro::load(MS794 *mice)
     auto block = ui->listMacroIndex->blockSignals(true);
     ui->listMacroIndex->setCurrentRow(0);
     ui->listMacroIndex->blockSignals(block);
+    setModified(false);
     return true;
 }
 
@@ -81,18 +105,10 @@ void PageMacro::save(MS794 *mice)
 
 void PageMacro::selectMacro(QListWidgetItem *current, QListWidgetItem *previous)
 {
-    setUpdatesEnabled(false);
-
     if (previous)
     {
         auto prevIndex = previous->data(QListWidgetItem::UserType).toInt();
         mice->setMacro(prevIndex, macro());
-
-        // Remove current controls
-        foreach (auto edit, ui->scrollAreaWidgetContents->findChildren<MacroEdit *>())
-        {
-            delete edit;
-        }
     }
 
     if (current)
@@ -104,6 +120,7 @@ void PageMacro::selectMacro(QListWidgetItem *current, QListWidgetItem *previous)
             QMessageBox::warning(this, windowTitle(), tr("Failed to load macro %1").arg(macroIndex, 3, 10, QChar('0')));
 
             // Unselect macro to prevent data loss
+            model->setActions(std::vector<MacroAction>());
             ui->cbAddAction->setFocus();
             ui->listMacroIndex->setCurrentRow(-1);
         }
@@ -112,137 +129,81 @@ void PageMacro::selectMacro(QListWidgetItem *current, QListWidgetItem *previous)
             setMacro(macro);
         }
     }
-
-    setUpdatesEnabled(true);
 }
 
 QByteArray PageMacro::macro() const
 {
-    QByteArray macro;
-    auto count = ui->repeat->value();
-    macro.append(0xFF & (count >> 8)).append(0xFF & count);
-
-    foreach (auto edit, ui->scrollAreaWidgetContents->findChildren<MacroEdit *>())
-    {
-        auto value = edit->value();
-        if (value == 0)
-        {
-            // Unassigned key, skip it
-            continue;
-        }
-
-        auto delay = edit->delay();
-        auto type = edit->actionType();
-        int extraDelay = 0;
+    return MacroCodec::encode(ui->repeat->value(), model->actions());
+}
 
-        if (delay > 127)
-        {
-            extraDelay = delay / 100;
-            delay %= 100;
-        }
+void PageMacro::setMacro(const QByteArray &macro)
+{
+    std::vector<MacroAction> actions;
+    auto repeat = MacroCodec::decode(macro, &actions);
+    ui->repeat->setValue(repeat);
+    model->setActions(actions);
+}
 
-        switch (type & (MacroEdit::ActionFlagDown | MacroEdit::ActionFlagUp))
-        {
-        case MacroEdit::ActionFlagDown:
-            macro.append(delay).append(value);
-            break;
-        case MacroEdit::ActionFlagDown | MacroEdit::ActionFlagUp:
-            macro.append(1).append(value).append(delay | 0x80).append(value);
-            break;
-        case MacroEdit::ActionFlagUp:
-            macro.append(delay | 0x80).append(value);
-            break;
-        }
+void PageMacro::updateSize(int bytes)
+{
+    ui->labelSize->setText(tr("%1 of %2 bytes").arg(bytes).arg(MS794::MaxMacroLength));
+}
 
-        if (extraDelay)
-        {
-            // Extra extra delay
-            if (extraDelay > 0xFF)
-            {
-                macro.append('\x0').append(EXTRA_DELAY).append(0xFF & (extraDelay >> 8)).append(0xFF & extraDelay);
-            }
-            else
-            {
-                macro.append(extraDelay).append(EXTRA_DELAY);
-            }
-        }
+void PageMacro::recordMacro(bool start)
+{
+    if (!start)
+    {
+        // Will continue at onRecordFinished
+        recorder->requestInterruption();
+        return;
     }
 
-    if (macro.length() == 2)
+    if (!recorder->open(ui->cbRecordDevice->currentText()))
     {
-        // Empty macro, repeat count only.
-        macro.resize(0);
+        QMessageBox::warning(this, windowTitle(), tr("Failed to open %1").arg(ui->cbRecordDevice->currentText()));
+        ui->btnRecord->setChecked(false);
+        return;
     }
 
-    // Add extra zeros to mark the end of macro
-    return macro.append("\x0\x0", 2);
+    ui->listMacroIndex->setEnabled(false);
+    ui->cbRecordDevice->setEnabled(false);
+    updateSize(MacroCodec::Overhead);
+    recorder->start(QThread::HighPriority);
 }
 
-void PageMacro::setMacro(QByteArray &macro)
+void PageMacro::onRecordSizeChanged(int bytes)
 {
-    // Add some zeros to not bother about boundaries
-    macro.append("\x0\x0\x0\x0", 4);
-    ui->repeat->setValue((quint8)macro.at(0) << 8 | (quint8)macro.at(1));
+    updateSize(bytes);
+}
 
-    for (int i = 2; i < macro.length(); i += 2)
-    {
-        int delay = 0xFF & macro.at(i);
-        int value = 0xFF & macro.at(i + 1);
+void PageMacro::onRecordFinished()
+{
+    auto actions = recorder->actions();
+    auto full = recorder->isFull();
+    recorder->close();
 
-        if (value == 0)
-        {
-            // End of macro
-            break;
-        }
+    auto block = ui->btnRecord->blockSignals(true);
+    ui->btnRecord->setChecked(false);
+    ui->btnRecord->blockSignals(block);
+    ui->listMacroIndex->setEnabled(true);
+    ui->cbRecordDevice->setEnabled(true);
 
-        int type = value < MS794::MouseLeftButton ? MacroEdit::ActionKey : MacroEdit::ActionButton;
+    if (actions.empty())
+        return;
 
-        if (delay & 0x80)
-        {
-            // Key/button up event
-            type |= MacroEdit::ActionFlagUp;
-            delay &= ~0x80;
-        }
-        else if (macro.at(i + 3) == (char)value && (0x80 & macro.at(i + 2)) && delay == 1)
-        {
-            // Down, then up => key press / button click
-            type |= MacroEdit::ActionFlagDown | MacroEdit::ActionFlagUp;
-            delay = 0x7F & macro.at(i + 2);
-            i += 2;
-        }
-        else
-        {
-            // Standalone key/button down
-            type |= MacroEdit::ActionFlagDown;
-        }
+    // Unlike load() & selectMacro(), the model reset is an edit here
+    model->setActions(actions);
+    markModified();
 
-        // Check for extended delay
-        if (macro.at(i + 3) == EXTRA_DELAY)
-        {
-            // Check for extended extended delay
-            if (macro.at(i + 2) == 0)
-            {
-                delay += 100 * (macro.at(i + 4) << 8 | macro.at(i + 5));
-                i += 4;
-            }
-            else
-            {
-                delay += 100 * macro.at(i + 2);
-                i += 2;
-            }
-        }
-
-        auto edit = new MacroEdit((MacroEdit::ActionType)type);
-        ui->scrollAreaWidgetLayout->insertWidget(ui->scrollAreaWidgetLayout->count() - 2, edit);
-        edit->setValue(value);
-        edit->setDelay(delay);
-        edit->setVisible(true);
+    if (full)
+    {
+        QMessageBox::information(this, windowTitle(), tr("The macro is full, the recording has been stopped"));
     }
 }
 
 void PageMacro::addAction(int idx)
 {
-    auto type = (MacroEdit::ActionType)ui->cbAddAction->itemData(idx).toInt();
+    auto type = ui->cbAddAction->itemData(idx).toInt();
 
     if (type == 0)
     {
@@ -250,19 +211,39 @@ void PageMacro::addAction(int idx)
         return;
     }
 
-    setUpdatesEnabled(false);
-    auto edit = new MacroEdit(type);
-    ui->scrollAreaWidgetLayout->insertWidget(ui->scrollAreaWidgetLayout->count() - 2, edit);
-    edit->setVisible(true);
-
     // Revert to "(add)"
     ui->cbAddAction->setCurrentIndex(0);
 
-    // Make sure the content is updated
-    qApp->processEvents();
+    MacroAction action = {type, (type & MacroAction::ActionButton) ? int(MS794::MouseLeftButton) : 0, 10};
+    auto index = model->appendAction(action);
+    ui->listActions->scrollTo(index);
+    ui->listActions->setCurrentIndex(index);
+    ui->listActions->edit(index);
+}
+
+void PageMacro::moveActionUp()
+{
+    auto row = ui->listActions->currentIndex().row();
+    if (model->moveAction(row, row - 1))
+        ui->listActions->setCurrentIndex(model->index(row - 1));
+}
+
+void PageMacro::moveActionDown()
+{
+    auto row = ui->listActions->currentIndex().row();
+    if (model->moveAction(row, row + 1))
+        ui->listActions->setCurrentIndex(model->index(row + 1));
+}
 
-    // Keep (add) combobox visible
-    ui->scrollArea->ensureWidgetVisible(ui->cbAddAction);
-    edit->setFocus();
-    setUpdatesEnabled(true);
+void PageMacro::removeAction()
+{
+    auto index = ui->listActions->currentIndex();
+    if (index.isValid())
+        model->removeRow(index.row());
+}
+
+void PageMacro::onActionsChanged()
+{
+    // The device keeps the macro padded with zeros, so measure the payload only.
+    updateSize(model->encodedSize());
 }
@@ -39,15 +39,28 @@ public:
     void save(class MS794 *mice);
 
     QByteArray macro() const;
-    void setMacro(QByteArray& macro);
+    void setMacro(const QByteArray &macro);
 
 public slots:
     void addAction(int idx);
     void selectMacro(class QListWidgetItem *current, class QListWidgetItem *previous);
+    void recordMacro(bool start);
+    void moveActionUp();
+    void moveActionDown();
+    void removeAction();
+
+private slots:
+    void onActionsChanged();
+    void onRecordSizeChanged(int bytes);
+    void onRecordFinished();
 
 private:
+    void updateSize(int bytes);
+
     Ui::PageMacro *ui;
     class MS794 *mice;
+    class MacroModel *model;
+    class MacroRecorder *recorder;
 };
 
 #endif // PAGEMACRO_H
@@ -19,18 +19,32 @@
 #include "pagerate.h"
 #include "ui_pagesensitivity.h"
 #include "ms794.h"
+#include "reportrateanalyzer.h"
+
+#include <QMessageBox>
+#include <QTimer>
+
+// Refresh the measured values 4 times a second
+#define MEASURE_UPDATE_INTERVAL 250
 
 PageRate::PageRate(QWidget *parent)
     : MiceWidget(parent)
     , ui(new Ui::PageSensitivity)
+    , analyzer(new ReportRateAnalyzer(this))
+    , timer(new QTimer(this))
 {
     ui->setupUi(this);
 
     ui->labelReportRate->setMinimumWidth(fontMetrics().width(tr("Refresh rate")));
+
+    timer->setInterval(MEASURE_UPDATE_INTERVAL);
+    connect(timer, SIGNAL(timeout()), this, SLOT(onMeasureUpdated()));
+    connect(ui->sliderReportRate, SIGNAL(valueChanged(int)), this, SLOT(markModified()));
 }
 
 PageRate::~PageRate()
 {
+    analyzer->stop();
     delete ui;
 }
 
@@ -42,6 +56,7 @@ bool PageRate::load(MS794 *mice)
 
     ui->sliderReportRate->setValue(valueRate);
     onReportRateChanged(valueRate);
+    setModified(false);
     return true;
 }
 
@@ -57,3 +72,39 @@ void PageRate::onReportRateChanged(int value)
 
     ui->labelReportRate->setText(tr("%1Hz").arg(125 * (1 << value)));
 }
+
+void PageRate::onMeasureToggled(bool start)
+{
+    if (!start)
+    {
+        timer->stop();
+        analyzer->stop();
+        onMeasureUpdated();
+        return;
+    }
+
+    // Note that an unsaved rate is not in effect yet, so the lost reports estimate will be off.
+    auto value = ui->sliderReportRate->value();
+    if (!analyzer->start(125 * (1 << (value - 1))))
+    {
+        QMessageBox::warning(this, windowTitle(), tr("Failed to open the mouse interface"));
+        ui->btnMeasure->setChecked(false);
+        return;
+    }
+
+    ui->labelMeasured->setText(tr("Keep moving the mouse..."));
+    timer->start();
+}
+
+void PageRate::onMeasureUpdated()
+{
+    if (analyzer->count() == 0)
+        return;
+
+    ui->labelMeasured->setText(tr("%1Hz, interval %2 msec (99%: %3 msec), jitter %4 msec, ~%5 reports lost")
+                                   .arg(analyzer->measuredRate(), 0, 'f', 0)
+                                   .arg(analyzer->percentile(50) / 1000, 0, 'f', 2)
+                                   .arg(analyzer->percentile(99) / 1000, 0, 'f', 2)
+                                   .arg(analyzer->jitter() / 1000, 0, 'f', 3)
+                                   .arg(analyzer->droppedEstimate()));
+}
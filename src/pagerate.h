@@ -38,9 +38,13 @@ public:
 
 private slots:
     void onReportRateChanged(int value);
+    void onMeasureToggled(bool start);
+    void onMeasureUpdated();
 
 private:
     Ui::PageSensitivity *ui;
+    class ReportRateAnalyzer *analyzer;
+    class QTimer *timer;
 };
 
 #endif // PAGESENSITIVITY_H
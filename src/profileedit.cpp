@@ -18,8 +18,12 @@
 
 #include "profileedit.h"
 #include "colorbutton.h"
+#include "colorswatch.h"
 #include "ms794.h"
 
+#include <qxtglobal.h>
+#include <QAbstractListModel>
+#include <QApplication>
 #include <QCheckBox>
 #include <QDebug>
 #include <QFormLayout>
@@ -56,6 +60,46 @@ static int DPI[] = {
     4000,
 };
 
+// The colors are the same for all the profiles, so is the model.
+class ProfileColorModel : public QAbstractListModel
+{
+public:
+    ProfileColorModel(const QSize &iconSize, QObject *parent)
+        : QAbstractListModel(parent)
+        , iconSize(iconSize)
+    {
+    }
+
+    int rowCount(const QModelIndex &parent) const
+    {
+        return parent.isValid() ? 0 : int(_countof(PROFILE_COLORS));
+    }
+
+    QVariant data(const QModelIndex &index, int role) const
+    {
+        if (role != Qt::DecorationRole || !index.isValid() || index.row() >= rowCount(QModelIndex()))
+            return QVariant();
+
+        return ColorSwatch::pixmap(QColor(PROFILE_COLORS[index.row()]).rgb() & 0xFFFFFF, iconSize);
+    }
+
+private:
+    QSize iconSize;
+};
+
+static QAbstractItemModel *colorModel(const QSize &iconSize)
+{
+    static ProfileColorModel *model = nullptr;
+
+    if (!model)
+    {
+        // Lives as long as the application does, all the profiles share it.
+        model = new ProfileColorModel(iconSize, qApp);
+    }
+
+    return model;
+}
+
 ProfileEdit::ProfileEdit(int index, QWidget *parent)
     : MiceWidget(parent)
     , indexValue(index)
@@ -85,21 +129,21 @@ ProfileEdit::ProfileEdit(int index, QWidget *parent)
     layout->addWidget(sliderDpi);
     layout->addSpacing(spacing);
 
-    auto labelColor = new QLabel(tr("&Color"));
+    labelColor = new QLabel(tr("&Color"));
     cbColor = new QComboBox;
     cbColor->setEditable(false);
-    for (const auto& color : PROFILE_COLORS)
-    {
-        QPixmap px(128, 128);
-        px.fill(QColor(color));
-        cbColor->addItem(px, "");
-    }
+    cbColor->setModel(colorModel(cbColor->iconSize()));
     labelColor->setBuddy(cbColor);
     layout->addWidget(labelColor);
     layout->addWidget(cbColor);
 
     layout->addStretch();
     setLayout(layout);
+
+    connect(btnActive, SIGNAL(toggled(bool)), this, SLOT(markModified()));
+    connect(checkEnabled, SIGNAL(toggled(bool)), this, SLOT(markModified()));
+    connect(sliderDpi, SIGNAL(valueChanged(int)), this, SLOT(markModified()));
+    connect(cbColor, SIGNAL(currentIndexChanged(int)), this, SLOT(markModified()));
 }
 
 bool ProfileEdit::load(class MS794 *mice)
@@ -115,6 +159,7 @@ bool ProfileEdit::load(class MS794 *mice)
     sliderDpi->setValue(dpi);
     onDpiChanged(dpi);
     cbColor->setCurrentIndex(color);
+    setModified(false);
     return true;
 }
 
@@ -155,19 +200,15 @@ void ProfileEdit::onEnableProfile(bool enabled)
     if (!enabled)
         btnActive->setChecked(false);
 
-    foreach (auto widget, findChildren<QWidget *>(QString(), Qt::FindDirectChildrenOnly))
+    QWidget *widgets[] = {btnActive, labelDpi, sliderDpi, labelColor, cbColor};
+    for (auto widget : widgets)
     {
-        if (checkEnabled == widget)
-            continue;
-
         widget->setEnabled(enabled);
     }
 }
 
 void ProfileEdit::onSelectProfile(bool)
 {
-    foreach (auto btn, parentWidget()->findChildren<QRadioButton *>())
-    {
-        btn->setChecked(btn == btnActive);
-    }
+    // The radio buttons are in different parents, so the owner takes care of the exclusivity.
+    emit activated();
 }
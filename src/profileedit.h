@@ -47,6 +47,10 @@ public:
 
     int index() const;
 
+signals:
+    // The user has selected this profile as the active one.
+    void activated();
+
 private slots:
     void onDpiChanged(int value);
     void onEnableProfile(bool enabled);
@@ -56,6 +60,7 @@ private:
     int indexValue;
     QCheckBox *checkEnabled;
     QLabel *labelDpi;
+    QLabel *labelColor;
     QComboBox *cbColor;
     QRadioButton *btnActive;
     QSlider *sliderDpi;
@@ -0,0 +1,240 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "reportrateanalyzer.h"
+#include "ms794.h"
+#include "qhiddevice.h"
+#include "qhidreportreader.h"
+
+#include <qxtglobal.h>
+#include <QDebug>
+#include <QJsonArray>
+
+#include <math.h>
+
+ReportRateAnalyzer::ReportRateAnalyzer(QObject *parent)
+    : QObject(parent)
+    , device(nullptr)
+    , reader(nullptr)
+    , histogram(NumBins, 0)
+    , nominalInterval(1000)
+{
+    reset();
+}
+
+ReportRateAnalyzer::~ReportRateAnalyzer()
+{
+    stop();
+}
+
+bool ReportRateAnalyzer::start(int nominalRate)
+{
+    stop();
+    reset();
+
+    nominalInterval = 1000000 / qMax(1, nominalRate);
+    device = MS794::openMouseInterface(this);
+
+    if (!device->isValid())
+    {
+        delete device;
+        device = nullptr;
+        return false;
+    }
+
+    reader = new QHIDReportReader(device, this);
+    connect(reader, SIGNAL(reportsAvailable()), this, SLOT(onReportsAvailable()));
+    reader->start(QThread::TimeCriticalPriority);
+    return true;
+}
+
+void ReportRateAnalyzer::stop()
+{
+    if (reader)
+    {
+        reader->stop();
+        onReportsAvailable();
+        overflowCount = reader->droppedCount();
+        delete reader;
+        reader = nullptr;
+    }
+
+    delete device;
+    device = nullptr;
+}
+
+bool ReportRateAnalyzer::isRunning() const
+{
+    return reader != nullptr;
+}
+
+void ReportRateAnalyzer::reset()
+{
+    std::fill(histogram.begin(), histogram.end(), 0);
+    lastTimestamp = -1;
+    lastSequence = 0;
+    intervals = 0;
+    dropped = 0;
+    overflowCount = 0;
+    sum = 0;
+    sumSquares = 0;
+    maxValue = 0;
+}
+
+void ReportRateAnalyzer::onReportsAvailable()
+{
+    if (!reader)
+        return;
+
+    QHIDReport reports[64];
+    int count;
+    bool changed = false;
+
+    while ((count = reader->takeReports(reports, int(_countof(reports)))) > 0)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            // The reports missing from the sequence were lost in the ring, they are counted by overflows().
+            // The interval across the gap says nothing about the device, so skip it.
+            if (lastTimestamp >= 0 && reports[i].sequence == lastSequence + 1)
+                addInterval(reports[i].timestamp - lastTimestamp);
+
+            lastTimestamp = reports[i].timestamp;
+            lastSequence = reports[i].sequence;
+        }
+        changed = true;
+    }
+
+    if (changed)
+        emit updated();
+}
+
+void ReportRateAnalyzer::addInterval(qint64 nsec)
+{
+    double usec = nsec / 1000.0;
+
+    if (usec > IdleFactor * nominalInterval)
+    {
+        // The mouse was not moving.
+        return;
+    }
+
+    ++intervals;
+    sum += usec;
+    sumSquares += usec * usec;
+    maxValue = qMax(maxValue, usec);
+    ++histogram[qMin(int(usec / BinWidth), NumBins - 1)];
+
+    // Two intervals in a row => one report is missing, and so on.
+    auto missed = qRound(usec / nominalInterval) - 1;
+    if (missed > 0)
+        dropped += missed;
+}
+
+int ReportRateAnalyzer::nominalRate() const
+{
+    return 1000000 / nominalInterval;
+}
+
+int ReportRateAnalyzer::count() const
+{
+    return intervals;
+}
+
+double ReportRateAnalyzer::measuredRate() const
+{
+    return sum > 0 ? intervals * 1000000.0 / sum : 0;
+}
+
+double ReportRateAnalyzer::meanInterval() const
+{
+    return intervals ? sum / intervals : 0;
+}
+
+double ReportRateAnalyzer::jitter() const
+{
+    if (!intervals)
+        return 0;
+
+    auto mean = sum / intervals;
+    return sqrt(qMax(0.0, sumSquares / intervals - mean * mean));
+}
+
+double ReportRateAnalyzer::percentile(double value) const
+{
+    auto threshold = value * intervals / 100.0;
+    int total = 0;
+
+    for (int bin = 0; bin < NumBins; ++bin)
+    {
+        total += histogram[bin];
+        if (total > 0 && total >= threshold)
+            return (bin + 0.5) * BinWidth;
+    }
+
+    return maxValue;
+}
+
+double ReportRateAnalyzer::maxInterval() const
+{
+    return maxValue;
+}
+
+int ReportRateAnalyzer::droppedEstimate() const
+{
+    return dropped;
+}
+
+int ReportRateAnalyzer::overflows() const
+{
+    return reader ? reader->droppedCount() : overflowCount;
+}
+
+QJsonObject ReportRateAnalyzer::toJson() const
+{
+    QJsonObject interval;
+    interval["mean"] = meanInterval();
+    interval["stddev"] = jitter();
+    interval["p50"] = percentile(50);
+    interval["p90"] = percentile(90);
+    interval["p99"] = percentile(99);
+    interval["p999"] = percentile(99.9);
+    interval["max"] = maxInterval();
+
+    QJsonArray bins;
+    for (int bin = 0; bin < NumBins; ++bin)
+    {
+        if (histogram[bin] == 0)
+            continue;
+
+        QJsonObject item;
+        item["us"] = bin * BinWidth;
+        item["count"] = histogram[bin];
+        bins.append(item);
+    }
+
+    QJsonObject json;
+    json["nominal_hz"] = nominalRate();
+    json["measured_hz"] = measuredRate();
+    json["intervals"] = count();
+    json["interval_us"] = interval;
+    json["dropped_estimate"] = droppedEstimate();
+    json["ring_overflows"] = overflows();
+    json["histogram"] = bins;
+    return json;
+}
@@ -0,0 +1,86 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef REPORTRATEANALYZER_H
+#define REPORTRATEANALYZER_H
+
+#include <QJsonObject>
+#include <QObject>
+#include <vector>
+
+// Measures the intervals between the reports of the mouse interface.
+// The mouse sends nothing while it stays still, so it must be moved during the measurement.
+class ReportRateAnalyzer : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Constants
+    {
+        // Histogram resolution, usec
+        BinWidth = 10,
+        // Covers 40 msec, 4 times the longest interval (125Hz)
+        NumBins = 4000,
+        // Longer gaps (in nominal intervals) mean the mouse was not moving
+        IdleFactor = 4,
+    };
+
+    explicit ReportRateAnalyzer(QObject *parent = 0);
+    ~ReportRateAnalyzer();
+
+    bool start(int nominalRate);
+    void stop();
+    bool isRunning() const;
+    void reset();
+
+    int nominalRate() const;
+    int count() const;
+    double measuredRate() const;
+    double meanInterval() const;
+    double jitter() const;
+    double percentile(double value) const;
+    double maxInterval() const;
+    int droppedEstimate() const;
+    int overflows() const;
+
+    QJsonObject toJson() const;
+
+signals:
+    void updated();
+
+private slots:
+    void onReportsAvailable();
+
+private:
+    void addInterval(qint64 nsec);
+
+    class QHIDDevice *device;
+    class QHIDReportReader *reader;
+    std::vector<int> histogram;
+    int nominalInterval;
+    qint64 lastTimestamp;
+    quint32 lastSequence;
+    int intervals;
+    int dropped;
+    int overflowCount;
+    double sum;
+    double sumSquares;
+    double maxValue;
+};
+
+#endif // REPORTRATEANALYZER_H
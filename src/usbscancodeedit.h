@@ -26,6 +26,9 @@ class UsbScanCodeEdit : public EnumEdit
     Q_OBJECT
 public:
     explicit UsbScanCodeEdit(QWidget *parent = 0);
+
+protected:
+    int findItem(const QString &name) const;
 };
 
 #endif // USBSCANCODEEDIT_H
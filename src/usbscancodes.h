@@ -0,0 +1,46 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef USBSCANCODES_H
+#define USBSCANCODES_H
+
+#include <QString>
+
+// USB HID keyboard usages (and the mouse buttons) with their names.
+class UsbScanCodes
+{
+public:
+    struct Item
+    {
+        const char *name;
+        int group;
+    };
+
+    static const Item *items();
+    static int itemCount();
+
+    static const Item *groups();
+    static int groupCount();
+
+    // Returns an empty string for unknown codes.
+    static const char *name(int code);
+    // Case insensitive, returns -1 for unknown names.
+    static int code(const QString &name);
+};
+
+#endif // USBSCANCODES_H
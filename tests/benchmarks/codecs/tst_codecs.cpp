@@ -0,0 +1,351 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "buttonbinding.h"
+#include "macrocodec.h"
+#include "ms794.h"
+#include "qhiddescriptor.h"
+#include "usbscancodes.h"
+
+#include <qxtglobal.h>
+#include <QtEndian>
+#include <QtTest>
+
+// The layout of MS794::PageButtons: the id, the macros, then a 32-bit binding per button.
+#define BUTTONS_PAGE_SIZE 1145
+#define BUTTONS_OFFSET (1 + MS794::MaxMacroNum * MS794::MaxMacroLength)
+#define NUM_BUTTONS (MS794::ButtonMinus + 1)
+
+// A mouse interface followed by a boot keyboard one, like the composite devices report.
+static const quint8 descriptor[] =
+{
+    0x05, 0x01, 0x09, 0x02, 0xA1, 0x01, 0x09, 0x01, 0xA1, 0x00, 0x05, 0x09, 0x19, 0x01, 0x29, 0x05,
+    0x15, 0x00, 0x25, 0x01, 0x95, 0x05, 0x75, 0x01, 0x81, 0x02, 0x95, 0x01, 0x75, 0x03, 0x81, 0x01,
+    0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x16, 0x01, 0x80, 0x26, 0xFF, 0x7F, 0x75, 0x10, 0x95, 0x02,
+    0x81, 0x06, 0x09, 0x38, 0x15, 0x81, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x01, 0x81, 0x06, 0xC0, 0xC0,
+    0x06, 0x00, 0xFF, 0x09, 0x01, 0xA1, 0x01, 0x85, 0x04, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08,
+    0x96, 0x3A, 0x00, 0x09, 0x01, 0xB1, 0x02, 0x85, 0x06, 0x96, 0x78, 0x04, 0x09, 0x01, 0xB1, 0x02,
+    0x85, 0x08, 0x95, 0x08, 0x09, 0x01, 0xB1, 0x02, 0xC0,
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7, 0x15, 0x00, 0x25, 0x01,
+    0x75, 0x01, 0x95, 0x08, 0x81, 0x02, 0x95, 0x01, 0x75, 0x08, 0x81, 0x01, 0x95, 0x05, 0x75, 0x01,
+    0x05, 0x08, 0x19, 0x01, 0x29, 0x05, 0x91, 0x02, 0x95, 0x01, 0x75, 0x03, 0x91, 0x01, 0x95, 0x06,
+    0x75, 0x08, 0x15, 0x00, 0x25, 0x65, 0x05, 0x07, 0x19, 0x00, 0x29, 0x65, 0x81, 0x00, 0xC0,
+};
+
+// The vendor interface the configuration pages go through
+static const quint8 featureDescriptor[] =
+{
+    0x06, 0x00, 0xFF, 0x09, 0x01, 0xA1, 0x01, 0x85, 0x04, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08,
+    0x96, 0x3A, 0x00, 0x09, 0x01, 0xB1, 0x02, 0x85, 0x06, 0x96, 0x78, 0x04, 0x09, 0x01, 0xB1, 0x02,
+    0x85, 0x08, 0x95, 0x08, 0x09, 0x01, 0xB1, 0x02, 0xC0,
+};
+
+// Codecs of the device formats: the macros, the button bindings and the HID descriptor.
+class BenchCodecs : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void macroEncode_data();
+    void macroEncode();
+    void macroDecode_data();
+    void macroDecode();
+
+    void bindingAccessors();
+    void bulkDecode_data();
+    void bulkDecode();
+    void bindingToString_data();
+    void bindingToString();
+    void bindingFromString_data();
+    void bindingFromString();
+
+    void findUsage_data();
+    void findUsage();
+    void parseDescriptor();
+
+private:
+    static void macroData();
+    static void bindingData();
+};
+
+void BenchCodecs::macroData()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("delay");
+
+    QTest::newRow("short") << 4 << 10;
+    QTest::newRow("short, long delays") << 4 << 5000;
+    // The key presses take 4 bytes each, so this one fills the whole macro.
+    QTest::newRow("full") << (MS794::MaxMacroLength - MacroCodec::Overhead) / 4 << 10;
+}
+
+static std::vector<MacroAction> makeActions(int count, int delay)
+{
+    std::vector<MacroAction> actions;
+    for (int i = 0; i < count; ++i)
+    {
+        MacroAction action = {MacroAction::ActionKeyPress, 4 + i % 26, delay};
+        actions.push_back(action);
+    }
+
+    return actions;
+}
+
+void BenchCodecs::macroEncode_data()
+{
+    macroData();
+}
+
+void BenchCodecs::macroEncode()
+{
+    QFETCH(int, count);
+    QFETCH(int, delay);
+
+    auto actions = makeActions(count, delay);
+    QByteArray macro;
+
+    QBENCHMARK
+    {
+        macro = MacroCodec::encode(1, actions);
+    }
+
+    QVERIFY(macro.size() <= MS794::MaxMacroLength);
+}
+
+void BenchCodecs::macroDecode_data()
+{
+    macroData();
+}
+
+void BenchCodecs::macroDecode()
+{
+    QFETCH(int, count);
+    QFETCH(int, delay);
+
+    auto macro = MacroCodec::encode(3, makeActions(count, delay));
+    std::vector<MacroAction> actions;
+    int repeat = 0;
+
+    QBENCHMARK
+    {
+        actions.clear();
+        repeat = MacroCodec::decode(macro, &actions);
+    }
+
+    QCOMPARE(repeat, 3);
+    QVERIFY(!actions.empty());
+}
+
+void BenchCodecs::bindingAccessors()
+{
+    // What ButtonEdit::load() does for every button
+    const ButtonBinding bindings[] = {
+        ButtonBinding::key(ButtonBinding::LeftCtrl, 6),
+        ButtonBinding::button(MS794::MouseBackButton),
+        ButtonBinding::dpiLock(3),
+        ButtonBinding::macro(2, MS794::MacroRepeatWhileHold),
+        ButtonBinding::sequence(4, 20, 3),
+    };
+    // Unsigned, so it wraps around instead of overflowing in the long runs
+    quint64 sum = 0;
+
+    QBENCHMARK
+    {
+        for (size_t i = 0; i < _countof(bindings); ++i)
+        {
+            auto binding = ButtonBinding(bindings[i].value()).withIndex(int(i));
+            sum += binding.event() + binding.modifiers() + binding.key1() + binding.key2() + binding.macroIndex()
+                + binding.repeatMode() + binding.sequenceCount() + binding.sequenceDelay() + binding.isValid();
+        }
+    }
+
+    QVERIFY(sum > 0);
+}
+
+void BenchCodecs::bulkDecode_data()
+{
+    QTest::addColumn<int>("backups");
+    QTest::addColumn<bool>("text");
+
+    QTest::newRow("10 backups") << 10 << false;
+    QTest::newRow("1000 backups") << 1000 << false;
+    QTest::newRow("1000 backups, as text") << 1000 << true;
+}
+
+// Every button of many button pages, as a batch check of the backups would do.
+void BenchCodecs::bulkDecode()
+{
+    QFETCH(int, backups);
+    QFETCH(bool, text);
+
+    const ButtonBinding bindings[] = {
+        ButtonBinding::button(MS794::MouseLeftButton),
+        ButtonBinding::key(ButtonBinding::LeftCtrl, 6),
+        ButtonBinding::key(ButtonBinding::RightAlt, 0xE0, 0x2B),
+        ButtonBinding::dpiLock(3),
+        ButtonBinding::profile(MS794::CycleProfile),
+        ButtonBinding::macro(2, MS794::MacroRepeatWhileHold),
+        ButtonBinding::sequence(4, 20, 3),
+        ButtonBinding::tripleClick(),
+        ButtonBinding::disabled(),
+        ButtonBinding(MS794::EventCustom | 0x12345600),
+    };
+
+    std::vector<QByteArray> pages;
+    int expected = 0;
+    for (int backup = 0; backup < backups; ++backup)
+    {
+        QByteArray page(BUTTONS_PAGE_SIZE, 0);
+        page[0] = char(MS794::PageButtons);
+
+        for (int i = 0; i < NUM_BUTTONS; ++i)
+        {
+            auto binding = bindings[(backup + i) % _countof(bindings)].withIndex(i);
+            expected += binding.isValid();
+            qToLittleEndian(binding.value(), (uchar *)page.data() + BUTTONS_OFFSET + 4 * i);
+        }
+
+        pages.push_back(page);
+    }
+
+    quint64 sum = 0;
+    int valid = 0;
+
+    QBENCHMARK
+    {
+        valid = 0;
+        for (const auto &page : pages)
+        {
+            auto bytes = (const uchar *)page.constData() + BUTTONS_OFFSET;
+            for (int i = 0; i < NUM_BUTTONS; ++i)
+            {
+                ButtonBinding binding(qFromLittleEndian<quint32>(bytes + 4 * i));
+                sum += binding.event() + binding.index() + binding.arg1() + binding.arg2() + binding.arg3();
+                valid += binding.isValid();
+
+                if (text)
+                    sum += binding.toString().length();
+            }
+        }
+    }
+
+    QCOMPARE(valid, expected);
+    QVERIFY(sum > 0);
+}
+
+void BenchCodecs::bindingData()
+{
+    QTest::addColumn<quint32>("value");
+
+    QTest::newRow("key") << ButtonBinding::key(ButtonBinding::LeftCtrl | ButtonBinding::LeftShift, 6).value();
+    QTest::newRow("keypad") << ButtonBinding::key(0, UsbScanCodes::code("Keypad +")).value();
+    QTest::newRow("button") << ButtonBinding::button(MS794::MouseForwardButton).value();
+    QTest::newRow("profile") << ButtonBinding::dpiLock(5).value();
+    QTest::newRow("macro") << ButtonBinding::macro(8, MS794::MacroRepeatUntilNextKey).value();
+    QTest::newRow("sequence") << ButtonBinding::sequence(4, 30, 5).value();
+    QTest::newRow("custom") << 0x12345600u;
+}
+
+void BenchCodecs::bindingToString_data()
+{
+    bindingData();
+}
+
+void BenchCodecs::bindingToString()
+{
+    QFETCH(quint32, value);
+
+    ButtonBinding binding(value);
+    QString text;
+
+    QBENCHMARK
+    {
+        text = binding.toString();
+    }
+
+    QVERIFY(!text.isEmpty());
+}
+
+void BenchCodecs::bindingFromString_data()
+{
+    bindingData();
+}
+
+void BenchCodecs::bindingFromString()
+{
+    QFETCH(quint32, value);
+
+    auto text = ButtonBinding(value).toString();
+    ButtonBinding binding;
+    bool ok = false;
+
+    QBENCHMARK
+    {
+        binding = ButtonBinding::fromString(text, &ok);
+    }
+
+    QVERIFY(ok);
+    QCOMPARE(binding.value(), value);
+}
+
+void BenchCodecs::findUsage_data()
+{
+    QTest::addColumn<int>("usagePage");
+    QTest::addColumn<int>("usage");
+    QTest::addColumn<bool>("found");
+
+    QTest::newRow("mouse") << 1 << 2 << true;
+    QTest::newRow("keyboard") << 7 << 6 << true;
+    QTest::newRow("missing") << 0x0C << 1 << false;
+}
+
+void BenchCodecs::findUsage()
+{
+    QFETCH(int, usagePage);
+    QFETCH(int, usage);
+    QFETCH(bool, found);
+
+    bool ret = !found;
+
+    QBENCHMARK
+    {
+        ret = QHIDDescriptor::findUsage(usagePage, usage, descriptor, sizeof(descriptor));
+    }
+
+    QCOMPARE(ret, found);
+}
+
+void BenchCodecs::parseDescriptor()
+{
+    QHIDDescriptor desc;
+
+    QBENCHMARK
+    {
+        QVERIFY(desc.parse(featureDescriptor, sizeof(featureDescriptor)));
+    }
+
+    // Same as the page sizes, the report id is not included.
+    QVERIFY(desc.usesReportIds());
+    QCOMPARE(desc.reportSize(QHIDDescriptor::Feature, MS794::PageLighting), 58);
+    QCOMPARE(desc.reportSize(QHIDDescriptor::Feature, MS794::PageButtons), 1144);
+    QCOMPARE(desc.reportSize(QHIDDescriptor::Feature, MS794::PageProfile), 8);
+    QCOMPARE(desc.reportSize(QHIDDescriptor::Input, MS794::PageProfile), -1);
+}
+
+QTEST_GUILESS_MAIN(BenchCodecs)
+#include "tst_codecs.moc"
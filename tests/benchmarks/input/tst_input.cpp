@@ -0,0 +1,179 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "qhiddevice.h"
+#include "qhidemulator.h"
+#include "qhidreportreader.h"
+
+#include <QtTest>
+
+static const int BatchSize = 64;
+
+// The input stream from the emulated device: the reader thread, the ring and the batches.
+class BenchInput : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void pull_data();
+    void pull();
+
+    void batches();
+    void overflow();
+
+public slots:
+    // Not a test, the consumer for batches()
+    void onReportsAvailable();
+
+private:
+    QHIDReportReader *reader;
+    int taken;
+    int notifications;
+    quint32 nextSequence;
+    bool ordered;
+};
+
+void BenchInput::init()
+{
+    QHIDEmulator::reset();
+    reader = nullptr;
+    taken = 0;
+    notifications = 0;
+    nextSequence = 0;
+    ordered = true;
+}
+
+void BenchInput::onReportsAvailable()
+{
+    QHIDReport reports[BatchSize];
+    int count;
+
+    ++notifications;
+    while (reader && (count = reader->takeReports(reports, BatchSize)) > 0)
+    {
+        for (int i = 0; i < count; ++i)
+            ordered &= reports[i].sequence == nextSequence++;
+
+        taken += count;
+    }
+}
+
+void BenchInput::pull_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("100 reports") << 100;
+    QTest::newRow("1000 reports") << 1000;
+}
+
+// From the device to the consumer, polling with the pull API.
+void BenchInput::pull()
+{
+    QFETCH(int, count);
+
+    // The emulator takes any ids
+    QHIDDevice device(0, 0, 0, 0);
+    QHIDReportReader stream(&device);
+    stream.start();
+
+    QByteArray report(8, 'x');
+    QHIDReport reports[BatchSize];
+
+    QBENCHMARK
+    {
+        for (int i = 0; i < count; ++i)
+            QHIDEmulator::pushInputReport(report);
+
+        QElapsedTimer timer;
+        timer.start();
+
+        for (int received = 0; received < count;)
+        {
+            auto n = stream.takeReports(reports, BatchSize);
+            if (n == 0)
+            {
+                QVERIFY2(timer.elapsed() < 5000, "The reader is stuck");
+                QThread::yieldCurrentThread();
+            }
+            received += n;
+        }
+    }
+
+    QCOMPARE(stream.droppedCount(), 0);
+}
+
+// Not timed: the result is the reports per signal, the more the better.
+void BenchInput::batches()
+{
+    const int count = 1000;
+
+    QHIDDevice device(0, 0, 0, 0);
+    QHIDReportReader stream(&device);
+    reader = &stream;
+    connect(&stream, SIGNAL(reportsAvailable()), this, SLOT(onReportsAvailable()));
+    stream.start();
+
+    QByteArray report(8, 'x');
+    for (int i = 0; i < count; ++i)
+        QHIDEmulator::pushInputReport(report);
+
+    QTRY_COMPARE(taken, count);
+    stream.stop();
+    reader = nullptr;
+
+    QVERIFY(ordered);
+    QVERIFY(notifications > 0 && notifications <= count);
+    QTest::setBenchmarkResult(qreal(count) / notifications, QTest::Events);
+}
+
+// The consumer is stuck, the newest reports are dropped and counted.
+void BenchInput::overflow()
+{
+    const int extra = 100;
+    const int count = QHIDReportReader::BufferSize + extra;
+
+    QHIDDevice device(0, 0, 0, 0);
+    QHIDReportReader stream(&device);
+    stream.start();
+
+    QByteArray report(8, 'x');
+    for (int i = 0; i < count; ++i)
+        QHIDEmulator::pushInputReport(report);
+
+    QTRY_COMPARE_WITH_TIMEOUT(stream.receivedCount(), count, 10000);
+    QCOMPARE(stream.droppedCount(), extra);
+
+    QHIDReport reports[BatchSize];
+    int n;
+    while ((n = stream.takeReports(reports, BatchSize)) > 0)
+    {
+        for (int i = 0; i < n; ++i)
+            ordered &= reports[i].sequence == nextSequence++;
+
+        taken += n;
+    }
+
+    QVERIFY(ordered);
+    QCOMPARE(taken, int(QHIDReportReader::BufferSize));
+    QCOMPARE(stream.receivedCount() - taken, stream.droppedCount());
+}
+
+QTEST_GUILESS_MAIN(BenchInput)
+#include "tst_input.moc"
@@ -0,0 +1,80 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "lightingeffect.h"
+#include "lightingengine.h"
+#include "ms794.h"
+#include "qhiddevice.h"
+#include "qhidemulator.h"
+
+#include <QtTest>
+
+// The sustainable frame rate of the lighting engine. The frames go all the way through
+// MS794::save() and QHIDDevice to the emulated device with the given latency & pacing.
+class BenchLighting : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void sustainableFps_data();
+    void sustainableFps();
+};
+
+void BenchLighting::init()
+{
+    QHIDEmulator::reset();
+}
+
+void BenchLighting::sustainableFps_data()
+{
+    QTest::addColumn<int>("latency");
+    QTest::addColumn<int>("writeDelay");
+
+    QTest::newRow("no latency") << 0 << 0;
+    QTest::newRow("1ms latency") << 1000 << 0;
+    QTest::newRow("1ms latency, paced") << 1000 << 20;
+    QTest::newRow("4ms latency, paced") << 4000 << 20;
+}
+
+// Not timed by QBENCHMARK: the result is the frames written per second at the highest rate.
+void BenchLighting::sustainableFps()
+{
+    QFETCH(int, latency);
+    QFETCH(int, writeDelay);
+
+    MS794 mice;
+    QVERIFY(mice.prefetch());
+    mice.hidDevice()->setWriteDelay(writeDelay);
+    QHIDEmulator::setLatency(latency);
+
+    LightingEngine engine(&mice);
+    engine.setEffect(LightingEffect::create("rainbow"));
+    engine.setMaxFps(LightingEngine::MaxFps);
+    QVERIFY(engine.start());
+
+    QTest::qWait(2000);
+    engine.stop();
+
+    QVERIFY(engine.writtenFrames() > 0);
+    QTest::setBenchmarkResult(engine.achievedFps(), QTest::FramesPerSecond);
+}
+
+QTEST_GUILESS_MAIN(BenchLighting)
+#include "tst_lighting.moc"
@@ -0,0 +1,273 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "ms794.h"
+#include "qhiddevice.h"
+#include "qhidemulator.h"
+#include "qhidstats.h"
+#include "qhidtrace.h"
+
+#include <QBuffer>
+#include <QtTest>
+
+// The device layer against the emulated mouse. The getters & setters run on a warm cache,
+// the save & restore do the I/O with the given latency per transaction.
+class BenchMS794 : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void getters();
+    void setters();
+    void unsavedChanges();
+
+    void save_data();
+    void save();
+
+    void restoreConfig_data();
+    void restoreConfig();
+
+    void ping_data();
+    void ping();
+
+    void pingFailure_data();
+    void pingFailure();
+};
+
+void BenchMS794::init()
+{
+    QHIDEmulator::reset();
+}
+
+void BenchMS794::getters()
+{
+    MS794 mice;
+    QVERIFY(mice.prefetch());
+    auto transactions = QHIDEmulator::transactionCount();
+    int sum = 0;
+
+    QBENCHMARK
+    {
+        sum += mice.reportRate() + mice.profile() + mice.numProfiles() + mice.lightType() + mice.lightValue();
+
+        for (int i = 0; i < MS794::MaxLightColor; ++i)
+            sum += mice.lightColor(i);
+
+        for (int i = MS794::ButtonLeft; i <= MS794::ButtonMinus; ++i)
+            sum += mice.button(MS794::ButtonIndex(i));
+
+        for (int i = 0; i < MS794::MaxProfile; ++i)
+            sum += mice.profileEnabled(i) + mice.profileDpi(i) + mice.profileColorIndex(i);
+
+        for (int i = 1; i <= MS794::MaxMacroNum; ++i)
+            sum += mice.macro(i).size();
+    }
+
+    // All from the cache
+    QCOMPARE(QHIDEmulator::transactionCount(), transactions);
+    QVERIFY(sum >= 0);
+}
+
+void BenchMS794::setters()
+{
+    MS794 mice;
+    QVERIFY(mice.prefetch());
+    auto transactions = QHIDEmulator::transactionCount();
+    int value = 0;
+
+    QBENCHMARK
+    {
+        value = (value + 1) % MS794::MaxLightColor;
+        mice.setLightType(value << 4);
+        mice.setLightValue(value);
+
+        for (int i = 0; i < MS794::MaxLightColor; ++i)
+            mice.setLightColor(i, value);
+
+        for (int i = MS794::ButtonLeft; i <= MS794::ButtonMinus; ++i)
+            mice.setButton(MS794::ButtonIndex(i), MS794::EventButton | value << 8 | i);
+
+        for (int i = 0; i < MS794::MaxProfile; ++i)
+            mice.setProfileDpi(i, value);
+    }
+
+    QCOMPARE(QHIDEmulator::transactionCount(), transactions);
+}
+
+void BenchMS794::unsavedChanges()
+{
+    MS794 mice;
+    QVERIFY(mice.prefetch());
+
+    // The worst case: the pages are dirty, but equal to the saved ones.
+    mice.setButton(MS794::ButtonMinus, mice.button(MS794::ButtonMinus));
+    mice.setLightType(mice.lightType());
+
+    QBENCHMARK
+    {
+        QVERIFY(!mice.unsavedChanges());
+    }
+}
+
+void BenchMS794::save_data()
+{
+    QTest::addColumn<int>("latency");
+    QTest::addColumn<int>("writeDelay");
+    QTest::addColumn<bool>("allPages");
+
+    QTest::newRow("profile page, no latency") << 0 << 0 << false;
+    QTest::newRow("profile page, 1ms latency") << 1000 << 0 << false;
+    QTest::newRow("all pages, no latency") << 0 << 0 << true;
+    QTest::newRow("all pages, 1ms latency") << 1000 << 0 << true;
+    QTest::newRow("all pages, 1ms latency, paced") << 1000 << 20 << true;
+}
+
+void BenchMS794::save()
+{
+    QFETCH(int, latency);
+    QFETCH(int, writeDelay);
+    QFETCH(bool, allPages);
+
+    MS794 mice;
+    QVERIFY(mice.prefetch());
+    mice.hidDevice()->setWriteDelay(writeDelay);
+    QHIDEmulator::setLatency(latency);
+    int value = 0;
+
+    QBENCHMARK
+    {
+        value = 1 + value % MS794::MaxReportRate;
+        mice.setReportRate(value);
+
+        if (allPages)
+        {
+            mice.setLightType(value << 4);
+            mice.setButton(MS794::ButtonMinus, MS794::EventButton | value << 8 | MS794::ButtonMinus);
+        }
+
+        QVERIFY(mice.save());
+    }
+}
+
+void BenchMS794::restoreConfig_data()
+{
+    QTest::addColumn<int>("latency");
+    QTest::addColumn<int>("writeDelay");
+
+    QTest::newRow("no latency") << 0 << 0;
+    QTest::newRow("1ms latency") << 1000 << 0;
+    QTest::newRow("1ms latency, paced") << 1000 << 20;
+}
+
+void BenchMS794::restoreConfig()
+{
+    QFETCH(int, latency);
+    QFETCH(int, writeDelay);
+
+    MS794 mice;
+    QBuffer backup;
+    QVERIFY(backup.open(QBuffer::ReadWrite));
+    QVERIFY(mice.backupConfig(&backup));
+
+    mice.hidDevice()->setWriteDelay(writeDelay);
+    QHIDEmulator::setLatency(latency);
+
+    QBENCHMARK
+    {
+        backup.seek(0);
+        QVERIFY(mice.restoreConfig(&backup));
+    }
+}
+
+void BenchMS794::ping_data()
+{
+    QTest::addColumn<int>("stalls");
+
+    QTest::newRow("no stalls") << 0;
+    QTest::newRow("1 stall") << 1;
+    QTest::newRow("3 stalls") << 3;
+}
+
+// The first ping after an arrival, the device stalls a few times and recovers.
+void BenchMS794::ping()
+{
+    QFETCH(int, stalls);
+
+    QHIDEmulator::setLatency(1000);
+
+    QBENCHMARK
+    {
+        MS794 mice;
+        QVERIFY(mice.open());
+        QHIDEmulator::setStallCount(stalls);
+        QVERIFY(mice.ping());
+    }
+}
+
+void BenchMS794::pingFailure_data()
+{
+    QTest::addColumn<bool>("unplugged");
+    QTest::addColumn<bool>("silent");
+
+    QTest::newRow("stalled") << false << false;
+    QTest::newRow("unplugged") << true << false;
+    // The hidapi-libusb backend does not set errno
+    QTest::newRow("stalled, no errno") << false << true;
+    QTest::newRow("unplugged, no errno") << true << true;
+}
+
+// Not a benchmark: the ping must give up within its budget, and at once if the device is gone.
+void BenchMS794::pingFailure()
+{
+    QFETCH(bool, unplugged);
+    QFETCH(bool, silent);
+
+    MS794 mice;
+    QVERIFY(mice.open());
+    QHIDEmulator::setLatency(1000);
+    QHIDEmulator::setSilentErrors(silent);
+
+    if (unplugged)
+        QHIDEmulator::setConnected(false);
+    else
+        QHIDEmulator::setFailAfter(0);
+
+    auto retries = QHIDStats::counters(QHIDTrace::GetFeatureReport).retries;
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(!mice.ping());
+    auto elapsed = timer.elapsed();
+    retries = QHIDStats::counters(QHIDTrace::GetFeatureReport).retries - retries;
+
+    if (unplugged)
+        QCOMPARE(retries, qint64(0));
+    else
+        QVERIFY(retries > 0);
+
+    // The ping budget plus some slack for a loaded machine
+    QVERIFY2(elapsed < 1000, qPrintable(QString("%1 msec").arg(elapsed)));
+
+    auto pattern = QString("%1-io-*.log").arg(QCoreApplication::applicationName());
+    foreach (auto file, QDir::temp().entryList(QStringList(pattern), QDir::Files))
+        QDir::temp().remove(file);
+}
+
+QTEST_GUILESS_MAIN(BenchMS794)
+#include "tst_ms794.moc"
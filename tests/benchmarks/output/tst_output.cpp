@@ -0,0 +1,191 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "qhiddevice.h"
+#include "qhidemulator.h"
+
+#include <QtTest>
+
+#if defined(__GLIBC__)
+// Every allocation of the process is counted, operator new included: it calls malloc.
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void __libc_free(void *ptr);
+
+static QBasicAtomicInt allocationCount = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+extern "C" void *malloc(size_t size)
+{
+    allocationCount.fetchAndAddRelaxed(1);
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    allocationCount.fetchAndAddRelaxed(1);
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    allocationCount.fetchAndAddRelaxed(1);
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+#endif
+
+// The output path of QHIDDevice against the emulated device: the chunked write, the batches,
+// and the heap allocations per call, which must be none once the device is warmed up.
+class BenchOutput : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void write_data();
+    void write();
+
+    void writeReports_data();
+    void writeReports();
+
+    void allocations_data();
+    void allocations();
+};
+
+void BenchOutput::init()
+{
+    QHIDEmulator::reset();
+}
+
+void BenchOutput::write_data()
+{
+    QTest::addColumn<int>("length");
+
+    QTest::newRow("1 report") << 60;
+    QTest::newRow("4 reports") << 250;
+    QTest::newRow("18 reports") << 1145;
+}
+
+void BenchOutput::write()
+{
+    QFETCH(int, length);
+
+    // The emulator takes any ids
+    QHIDDevice device(0, 0, 0, 0);
+    device.setWriteDelay(0);
+    QByteArray data(length, 'x');
+
+    QBENCHMARK
+    {
+        QCOMPARE(device.write(1, data.cbegin(), length), length);
+    }
+}
+
+void BenchOutput::writeReports_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("writeDelay");
+    QTest::addColumn<bool>("batched");
+
+    QTest::newRow("8 reports, one by one") << 8 << 0 << false;
+    QTest::newRow("8 reports, batched") << 8 << 0 << true;
+    QTest::newRow("8 reports, paced, one by one") << 8 << 2 << false;
+    QTest::newRow("8 reports, paced, batched") << 8 << 2 << true;
+}
+
+void BenchOutput::writeReports()
+{
+    QFETCH(int, count);
+    QFETCH(int, writeDelay);
+    QFETCH(bool, batched);
+
+    QHIDDevice device(0, 0, 0, 0);
+    device.setWriteDelay(writeDelay);
+
+    char data[8] = {0};
+    std::vector<QHIDOutputReport> reports(size_t(count), QHIDOutputReport {1, data, int(sizeof(data))});
+
+    QBENCHMARK
+    {
+        if (batched)
+        {
+            QCOMPARE(device.writeReports(reports.data(), count), count);
+        }
+        else
+        {
+            for (const auto &item : reports)
+                QCOMPARE(device.write(item.report, item.data, item.length), item.length);
+        }
+    }
+}
+
+void BenchOutput::allocations_data()
+{
+    QTest::addColumn<int>("length");
+    QTest::addColumn<bool>("batched");
+
+    QTest::newRow("write, 1 report") << 60 << false;
+    QTest::newRow("write, 18 reports") << 1145 << false;
+    QTest::newRow("writeReports, 8 reports") << 8 << true;
+}
+
+// Not timed: the result is the allocations per call.
+void BenchOutput::allocations()
+{
+#if defined(__GLIBC__)
+    QFETCH(int, length);
+    QFETCH(bool, batched);
+
+    QHIDDevice device(0, 0, 0, 0);
+    device.setWriteDelay(0);
+    QByteArray data(length, 'x');
+    std::vector<QHIDOutputReport> reports(8, QHIDOutputReport {1, data.cbegin(), length});
+
+    const int rounds = 1000;
+    bool ok = true;
+
+    // The first write sizes the buffer
+    for (int i = 0; i <= rounds; ++i)
+    {
+        if (i == 1)
+            allocationCount.store(0);
+
+        // No QCOMPARE here, it formats the values even on success.
+        if (batched)
+            ok &= device.writeReports(reports.data(), int(reports.size())) == int(reports.size());
+        else
+            ok &= device.write(1, data.cbegin(), length) == length;
+    }
+
+    auto count = allocationCount.load();
+    QVERIFY(ok);
+    QTest::setBenchmarkResult(qreal(count) / rounds, QTest::Events);
+    QCOMPARE(count, 0);
+#else
+    QSKIP("The allocations are counted with glibc only");
+#endif
+}
+
+QTEST_GUILESS_MAIN(BenchOutput)
+#include "tst_output.moc"
@@ -0,0 +1,298 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "buttonbinding.h"
+#include "buttonedit.h"
+#include "macrocodec.h"
+#include "ms794.h"
+#include "pagelight.h"
+#include "pagemacro.h"
+#include "qhidemulator.h"
+
+#include <QComboBox>
+#include <QtTest>
+#include <memory>
+
+#ifdef Q_OS_LINUX
+#include <linux/input.h>
+#endif
+
+// The editors the main window builds for every tab. Run with QT_QPA_PLATFORM=offscreen
+// where no display is available.
+class BenchWidgets : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void buttonEditCreate();
+    void buttonEditLoad_data();
+    void buttonEditLoad();
+    void buttonEditSave();
+    void buttonEditModeSwitch();
+
+    void registrySave_data();
+    void registrySave();
+
+    void pageLightLoad();
+    void pageLightTypeSwitch();
+
+    void pageMacroLoad();
+    void pageMacroSetMacro();
+    void pageMacroRecord();
+};
+
+void BenchWidgets::init()
+{
+    QHIDEmulator::reset();
+}
+
+void BenchWidgets::buttonEditCreate()
+{
+    QBENCHMARK
+    {
+        ButtonEdit edit("Left", MS794::ButtonLeft);
+    }
+}
+
+void BenchWidgets::buttonEditLoad_data()
+{
+    QTest::addColumn<quint32>("value");
+
+    QTest::newRow("key") << ButtonBinding::key(ButtonBinding::LeftCtrl | ButtonBinding::LeftAlt, 6, 7).value();
+    QTest::newRow("button") << ButtonBinding::button(MS794::MouseBackButton).value();
+    QTest::newRow("profile") << ButtonBinding::dpiLock(4).value();
+    QTest::newRow("macro") << ButtonBinding::macro(2, MS794::MacroRepeatWhileHold).value();
+    QTest::newRow("sequence") << ButtonBinding::sequence(4, 20, 3).value();
+}
+
+void BenchWidgets::buttonEditLoad()
+{
+    QFETCH(quint32, value);
+
+    MS794 mice;
+    QVERIFY(mice.prefetch());
+    mice.setButton(MS794::ButtonBack, int(ButtonBinding(value).withIndex(MS794::ButtonBack).value()));
+    ButtonEdit edit("Back", MS794::ButtonBack);
+
+    QBENCHMARK
+    {
+        QVERIFY(edit.load(&mice));
+    }
+
+    QCOMPARE(ButtonBinding(edit.value()).event(), ButtonBinding(value).event());
+}
+
+void BenchWidgets::buttonEditSave()
+{
+    MS794 mice;
+    QVERIFY(mice.prefetch());
+    ButtonEdit edit("Back", MS794::ButtonBack);
+    edit.setValue(ButtonBinding::macro(3, MS794::MacroRepeatCount).withIndex(MS794::ButtonBack).value());
+
+    QBENCHMARK
+    {
+        edit.save(&mice);
+    }
+
+    QCOMPARE(ButtonBinding(quint32(mice.button(MS794::ButtonBack))).macroIndex(), 3);
+}
+
+void BenchWidgets::buttonEditModeSwitch()
+{
+    ButtonEdit edit("Forward", MS794::ButtonForward);
+    auto mode = edit.findChild<QComboBox *>();
+    QVERIFY(mode);
+    int idx = 0;
+
+    QBENCHMARK
+    {
+        idx = (idx + 1) % mode->count();
+        mode->setCurrentIndex(idx);
+    }
+}
+
+void BenchWidgets::registrySave_data()
+{
+    QTest::addColumn<int>("numEditors");
+    QTest::addColumn<bool>("allModified");
+
+    QTest::newRow("7 editors, one modified") << 7 << false;
+    QTest::newRow("70 editors, one modified") << 70 << false;
+    QTest::newRow("70 editors, all modified") << 70 << true;
+}
+
+// The main window keeps its editors in a registry and saves the modified ones only.
+void BenchWidgets::registrySave()
+{
+    QFETCH(int, numEditors);
+    QFETCH(bool, allModified);
+
+    MS794 mice;
+    QVERIFY(mice.prefetch());
+
+    std::vector<std::unique_ptr<ButtonEdit>> owner;
+    std::vector<MiceWidget *> editors;
+    for (int i = 0; i < numEditors; ++i)
+    {
+        auto button = i % (MS794::ButtonMinus + 1);
+        owner.emplace_back(new ButtonEdit(QString::number(i), button));
+        QVERIFY(owner.back()->load(&mice));
+        editors.push_back(owner.back().get());
+    }
+
+    auto modifiedButton = MS794::ButtonIndex(numEditors / 2 % (MS794::ButtonMinus + 1));
+    auto modified = owner[numEditors / 2].get();
+    auto value = ButtonBinding::macro(3, MS794::MacroRepeatCount).withIndex(modifiedButton).value();
+    size_t saved = 0;
+
+    QBENCHMARK
+    {
+        if (allModified)
+        {
+            for (auto editor : editors)
+                editor->setModified(true);
+        }
+        else
+        {
+            modified->setValue(value);
+            modified->setModified(true);
+        }
+
+        saved = MiceWidget::saveModified(editors, &mice).size();
+    }
+
+    QCOMPARE(saved, allModified ? editors.size() : size_t(1));
+    if (!allModified)
+        QCOMPARE(ButtonBinding(quint32(mice.button(modifiedButton))).macroIndex(), 3);
+}
+
+void BenchWidgets::pageLightLoad()
+{
+    MS794 mice;
+    QVERIFY(mice.prefetch());
+    PageLight page;
+    int type = 0;
+
+    QBENCHMARK
+    {
+        type = (type + 1) % (MS794::MaxLightType + 1);
+        mice.setLightType(type << 4);
+        QVERIFY(page.load(&mice));
+    }
+}
+
+void BenchWidgets::pageLightTypeSwitch()
+{
+    PageLight page;
+    auto type = page.findChild<QComboBox *>("cbType");
+    QVERIFY(type);
+    int idx = 0;
+
+    QBENCHMARK
+    {
+        idx = (idx + 1) % type->count();
+        type->setCurrentIndex(idx);
+    }
+}
+
+void BenchWidgets::pageMacroLoad()
+{
+    MS794 mice;
+    QVERIFY(mice.prefetch());
+
+    std::vector<MacroAction> actions;
+    for (int i = 0; i < 16; ++i)
+    {
+        MacroAction action = {MacroAction::ActionKeyPress, 4 + i, 10};
+        actions.push_back(action);
+    }
+
+    auto macro = MacroCodec::encode(1, actions);
+    for (int i = 1; i <= MS794::MaxMacroNum; ++i)
+        mice.setMacro(i, macro);
+
+    PageMacro page;
+
+    QBENCHMARK
+    {
+        QVERIFY(page.load(&mice));
+    }
+}
+
+void BenchWidgets::pageMacroSetMacro()
+{
+    std::vector<MacroAction> actions;
+    for (int i = 0; i < (MS794::MaxMacroLength - MacroCodec::Overhead) / 4; ++i)
+    {
+        MacroAction action = {MacroAction::ActionKeyPress, 4 + i % 26, 10};
+        actions.push_back(action);
+    }
+
+    auto macro = MacroCodec::encode(1, actions);
+    PageMacro page;
+    QByteArray result;
+
+    QBENCHMARK
+    {
+        page.setMacro(macro);
+        result = page.macro();
+    }
+
+    QVERIFY(!result.isEmpty());
+}
+
+void BenchWidgets::pageMacroRecord()
+{
+#ifdef Q_OS_LINUX
+    // The recorder reads the raw input events from a file just like from a device
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    int values[] = {1, 0};
+    for (auto value : values)
+    {
+        input_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.type = EV_KEY;
+        ev.code = KEY_A;
+        ev.value = value;
+        QCOMPARE(file.write(reinterpret_cast<const char *>(&ev), sizeof(ev)), qint64(sizeof(ev)));
+    }
+    file.flush();
+
+    PageMacro page;
+    page.setModified(false);
+    auto device = page.findChild<QComboBox *>("cbRecordDevice");
+    QVERIFY(device);
+    device->setEditText(file.fileName());
+
+    QSignalSpy changed(&page, SIGNAL(changed()));
+    page.recordMacro(true);
+
+    // Saving & the close prompt depend on the modified flag
+    QTRY_VERIFY(page.isModified());
+    QVERIFY(changed.count() > 0);
+    QVERIFY(page.macro().size() > MacroCodec::Overhead);
+#else
+    QSKIP("Recording is supported on Linux only");
+#endif
+}
+
+QTEST_MAIN(BenchWidgets)
+#include "tst_widgets.moc"
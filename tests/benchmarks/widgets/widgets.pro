@@ -0,0 +1,69 @@
+###############################################################################
+#
+#      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+#
+#      This program is free software; you can redistribute it and/or modify
+#      it under the terms of the GNU General Public License as published by
+#      the Free Software Foundation; either version 2 of the License, or
+#      (at your option) any later version.
+#
+#      This program is distributed in the hope that it will be useful,
+#      but WITHOUT ANY WARRANTY; without even the implied warranty of
+#      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#      GNU General Public License for more details.
+#
+#      You should have received a copy of the GNU General Public License along
+#      with this program; if not, write to the Free Software Foundation, Inc.,
+#      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+###############################################################################
+
+include (../../tests.pri)
+include (../../../libqxt/libqxt.pri)
+
+QT += gui widgets
+
+TARGET = tst_widgets
+
+SOURCES += tst_widgets.cpp \
+    $$SRCDIR/buttonbinding.cpp \
+    $$SRCDIR/buttonedit.cpp \
+    $$SRCDIR/colorbutton.cpp \
+    $$SRCDIR/colorswatch.cpp \
+    $$SRCDIR/enumedit.cpp \
+    $$SRCDIR/lightpreview.cpp \
+    $$SRCDIR/macrocodec.cpp \
+    $$SRCDIR/macrodelegate.cpp \
+    $$SRCDIR/macroedit.cpp \
+    $$SRCDIR/macromodel.cpp \
+    $$SRCDIR/macrorecorder.cpp \
+    $$SRCDIR/mousebuttonbox.cpp \
+    $$SRCDIR/ms794.cpp \
+    $$SRCDIR/pagelight.cpp \
+    $$SRCDIR/pagemacro.cpp \
+    $$SRCDIR/usbscancodeedit.cpp \
+    $$SRCDIR/usbscancodes.cpp
+
+HEADERS += $$SRCDIR/buttonbinding.h \
+    $$SRCDIR/buttonedit.h \
+    $$SRCDIR/colorbutton.h \
+    $$SRCDIR/colorswatch.h \
+    $$SRCDIR/enumedit.h \
+    $$SRCDIR/lightpreview.h \
+    $$SRCDIR/macrocodec.h \
+    $$SRCDIR/macrodelegate.h \
+    $$SRCDIR/macroedit.h \
+    $$SRCDIR/macromodel.h \
+    $$SRCDIR/macrorecorder.h \
+    $$SRCDIR/micewidget.h \
+    $$SRCDIR/mousebuttonbox.h \
+    $$SRCDIR/ms794.h \
+    $$SRCDIR/pagelight.h \
+    $$SRCDIR/pagemacro.h \
+    $$SRCDIR/usbscancodeedit.h \
+    $$SRCDIR/usbscancodes.h
+
+FORMS += $$PWD/../../../ui/pagelight.ui \
+    $$PWD/../../../ui/pagemacro.ui
+
+RESOURCES += $$PWD/../../../res/hv-ms794-config.qrc
@@ -0,0 +1,56 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "qhiddescriptor.h"
+
+#include <stdlib.h>
+#include <vector>
+
+// The report descriptors come from any device with the same VID & PID.
+// The input is the usage page & usage (2 bytes each) followed by the descriptor.
+extern "C" int LLVMFuzzerTestOneInput(const quint8 *data, size_t size)
+{
+    if (size < 4)
+        return 0;
+
+    auto usagePage = data[0] << 8 | data[1];
+    auto usage = data[2] << 8 | data[3];
+
+    // An exact size copy, so the address sanitizer catches the reads past the end.
+    std::vector<quint8> desc(data + 4, data + size);
+    auto bytes = desc.empty() ? nullptr : desc.data();
+    QHIDDescriptor::findUsage(usagePage, usage, bytes, desc.size());
+
+    // The report table sizes the device buffers, so it must be sane.
+    QHIDDescriptor descriptor;
+    if (descriptor.parse(bytes, desc.size()))
+    {
+        for (int type = 0; type < QHIDDescriptor::NumReportTypes; ++type)
+        {
+            auto length = descriptor.maxReportSize(QHIDDescriptor::ReportType(type));
+            if (length < 0 || length > 0xFFFF)
+                abort();
+        }
+
+        // Same as the cache does
+        auto cached = QHIDDescriptor::fromJson(descriptor.toJson());
+        if (cached.hasUsage(usagePage, usage) != descriptor.hasUsage(usagePage, usage))
+            abort();
+    }
+    return 0;
+}
@@ -0,0 +1,35 @@
+###############################################################################
+#
+#      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+#
+#      This program is free software; you can redistribute it and/or modify
+#      it under the terms of the GNU General Public License as published by
+#      the Free Software Foundation; either version 2 of the License, or
+#      (at your option) any later version.
+#
+#      This program is distributed in the hope that it will be useful,
+#      but WITHOUT ANY WARRANTY; without even the implied warranty of
+#      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#      GNU General Public License for more details.
+#
+#      You should have received a copy of the GNU General Public License along
+#      with this program; if not, write to the Free Software Foundation, Inc.,
+#      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+###############################################################################
+
+# libFuzzer provides main(), the sanitizers catch the memory errors & undefined behaviour
+# the fuzzer does not notice itself. Set SANITIZERS to override, i.e. "fuzzer,memory".
+
+isEmpty(SANITIZERS): SANITIZERS = fuzzer,address,undefined
+
+CONFIG  += c++11 console
+CONFIG  -= app_bundle
+QT       = core
+TEMPLATE = app
+
+QMAKE_CXXFLAGS += -g -O1 -fno-omit-frame-pointer -fsanitize=$$SANITIZERS -fno-sanitize-recover=undefined
+QMAKE_LFLAGS   += -fsanitize=$$SANITIZERS
+
+SRCDIR = $$PWD/../../src
+INCLUDEPATH += $$SRCDIR $$PWD/../../libqhid
@@ -0,0 +1,49 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "macrocodec.h"
+
+#include <stdlib.h>
+
+// The macros come from the device as is, any garbage in the buttons page ends up here.
+extern "C" int LLVMFuzzerTestOneInput(const quint8 *data, size_t size)
+{
+    // Same as PageMacro does: the macro is no longer than MaxMacroLength, but the decoder
+    // must not rely on it.
+    auto macro = QByteArray::fromRawData(reinterpret_cast<const char *>(data), int(size));
+    std::vector<MacroAction> actions;
+    MacroCodec::decode(macro, &actions);
+
+    foreach (const auto &action, actions)
+    {
+        // The end of macro mark can't be an action
+        if (action.value == 0 || action.delay < 0)
+            abort();
+
+        if (!(action.type & (MacroAction::ActionFlagDown | MacroAction::ActionFlagUp)))
+            abort();
+
+        if (MacroCodec::actionSize(action) <= 0)
+            abort();
+    }
+
+    // What the editor does with the decoded macro on save.
+    std::vector<MacroAction> reencoded;
+    MacroCodec::decode(MacroCodec::encode(1, actions), &reencoded);
+    return 0;
+}
@@ -0,0 +1,374 @@
+/*
+ *      Copyright 2018 Pavel Bludov <pbludov@gmail.com>
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "ms794.h"
+#include "qhiddevice.h"
+#include "qhidemulator.h"
+#include "qhidflightrecorder.h"
+
+#include <QBuffer>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QtTest>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+// Randomized edit/save/restore/reconnect cycles against the emulated device.
+// The run is split into the windows, each one is sampled for the cycle latency,
+// the resident memory and the open files. The test fails if any of them grows.
+//
+// Environment:
+//   SOAK_DURATION   seconds, 60 by default. Hours are fine.
+//   SOAK_WINDOWS    number of the samples, 10 by default. The first one is the warm up.
+//   SOAK_LATENCY    emulated device latency per transaction, usec. 0 by default.
+//   SOAK_SEED       random seed, the current time by default.
+//   SOAK_REPORT     CSV file to write the samples to.
+
+static int envInt(const char *name, int defaultValue)
+{
+    bool ok = false;
+    auto value = qgetenv(name).toInt(&ok);
+    return ok ? value : defaultValue;
+}
+
+// kB, -1 if not supported
+static qint64 residentSize()
+{
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QFile::ReadOnly))
+        return -1;
+
+    auto fields = statm.readAll().split(' ');
+    return fields.size() > 1 ? fields[1].toLongLong() * sysconf(_SC_PAGESIZE) / 1024 : -1;
+#else
+    return -1;
+#endif
+}
+
+// -1 if not supported
+static int openFiles()
+{
+#ifdef Q_OS_LINUX
+    return QDir("/proc/self/fd").entryList(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot).size();
+#else
+    return -1;
+#endif
+}
+
+// The least squares slope of the values, per sample.
+static double slope(const std::vector<double> &values)
+{
+    auto n = double(values.size());
+    double sumX = 0, sumY = 0, sumXY = 0, sumXX = 0;
+
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        sumX += i;
+        sumY += values[i];
+        sumXY += i * values[i];
+        sumXX += double(i) * i;
+    }
+
+    auto d = n * sumXX - sumX * sumX;
+    return d > 0 ? (n * sumXY - sumX * sumY) / d : 0;
+}
+
+static int randomInt(int max)
+{
+    return qrand() % max;
+}
+
+class SoakTest : public QObject
+{
+    Q_OBJECT
+
+    struct Sample
+    {
+        qint64 elapsed;
+        int cycles;
+        int failures;
+        // usec
+        double p50;
+        double p99;
+        double max;
+        qint64 rss;
+        int files;
+    };
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void soak();
+
+private:
+    void edit();
+    bool cycle();
+    // The device failures are injected, so are the flight recorder dumps.
+    QStringList dumps();
+    void removeDumps();
+    void check(const char *name, const std::vector<double> &values, double tolerance);
+
+    MS794 *mice;
+    QBuffer backup;
+    int failures;
+    std::vector<Sample> samples;
+};
+
+void SoakTest::initTestCase()
+{
+    auto seed = uint(envInt("SOAK_SEED", int(QDateTime::currentMSecsSinceEpoch())));
+    qsrand(seed);
+    qDebug() << "seed" << seed;
+
+    // The injected failures are expected.
+    QLoggingCategory::setFilterRules("usb.warning=false");
+    removeDumps();
+
+    QHIDEmulator::reset();
+    QHIDEmulator::setLatency(envInt("SOAK_LATENCY", 0));
+    failures = 0;
+    mice = new MS794;
+    QVERIFY(mice->prefetch());
+    QVERIFY(backup.open(QBuffer::ReadWrite));
+    QVERIFY(mice->backupConfig(&backup));
+}
+
+void SoakTest::cleanupTestCase()
+{
+    delete mice;
+    mice = nullptr;
+    QCOMPARE(QHIDEmulator::openCount(), 0);
+    removeDumps();
+}
+
+void SoakTest::edit()
+{
+    switch (randomInt(6))
+    {
+    case 0:
+        mice->setButton(MS794::ButtonIndex(randomInt(MS794::ButtonMinus + 1)),
+            MS794::EventButton | (MS794::MouseLeftButton + randomInt(5)) << 8);
+        break;
+    case 1:
+    {
+        QByteArray macro(1 + randomInt(MS794::MaxMacroLength), 0);
+        for (int i = 0; i < macro.size(); ++i)
+            macro[i] = char(randomInt(256));
+        mice->setMacro(1 + randomInt(MS794::MaxMacroNum), macro);
+        break;
+    }
+    case 2:
+        mice->setLightType(randomInt(MS794::MaxLightType + 1) << 4);
+        break;
+    case 3:
+        mice->setLightColor(randomInt(MS794::MaxLightColor), randomInt(0x1000000));
+        break;
+    case 4:
+        mice->setReportRate(1 + randomInt(MS794::MaxReportRate));
+        break;
+    default:
+        mice->setProfileDpi(randomInt(MS794::MaxProfile), randomInt(MS794::MaxDpi + 1));
+        break;
+    }
+}
+
+// Returns false on unexpected failure.
+bool SoakTest::cycle()
+{
+    auto action = randomInt(1000);
+
+    // The injected failures are rare, each one leaves a flight recorder dump.
+    if (action < 5)
+    {
+        // The failed save must keep the changes.
+        edit();
+        QHIDEmulator::setFailAfter(0);
+        ++failures;
+        auto ok = mice->save() != mice->unsavedChanges();
+        QHIDEmulator::setFailAfter(-1);
+        return ok && mice->save();
+    }
+
+    if (action < 10 || action >= 900)
+    {
+        // A brand new instance, some of the pages may fail to load.
+        delete mice;
+        mice = new MS794;
+
+        if (action < 10)
+        {
+            QHIDEmulator::setFailAfter(randomInt(3));
+            ++failures;
+            mice->prefetch();
+            QHIDEmulator::setFailAfter(-1);
+        }
+
+        return mice->prefetch() && QHIDEmulator::openCount() == 1;
+    }
+
+    if (action < 600)
+    {
+        for (int i = 1 + randomInt(4); i > 0; --i)
+            edit();
+
+        return mice->save() && !mice->unsavedChanges();
+    }
+
+    if (action < 750)
+    {
+        backup.seek(0);
+        return mice->restoreConfig(&backup);
+    }
+
+    // The monitor makes the mice to reopen the device.
+    QHIDEmulator::setConnected(false);
+    QHIDEmulator::setConnected(true);
+    return QHIDEmulator::openCount() == 1 && mice->ping();
+}
+
+QStringList SoakTest::dumps()
+{
+    auto pattern = QString("%1-io-*.log").arg(QCoreApplication::applicationName());
+    return QDir::temp().entryList(QStringList(pattern), QDir::Files);
+}
+
+void SoakTest::removeDumps()
+{
+    foreach (auto file, dumps())
+        QDir::temp().remove(file);
+}
+
+void SoakTest::soak()
+{
+    auto duration = qint64(envInt("SOAK_DURATION", 60)) * 1000;
+    auto windows = qMax(3, envInt("SOAK_WINDOWS", 10));
+    mice->hidDevice()->setWriteDelay(0);
+
+    QElapsedTimer total;
+    total.start();
+
+    for (int window = 1; window <= windows; ++window)
+    {
+        std::vector<double> latencies;
+        failures = 0;
+
+        while (total.elapsed() < duration * window / windows)
+        {
+            QElapsedTimer timer;
+            timer.start();
+            auto ok = cycle();
+            latencies.push_back(timer.nsecsElapsed() / 1000.0);
+
+            // The reopened device gets the default pacing.
+            mice->hidDevice()->setWriteDelay(0);
+            QVERIFY2(ok, qPrintable(QString("cycle %1 failed").arg(latencies.size())));
+        }
+
+        // The injected failures dump the device I/O, the old dumps must go away.
+        QVERIFY(dumps().size() <= QHIDFlightRecorder::MaxDumps);
+        QVERIFY(!latencies.empty());
+        std::sort(latencies.begin(), latencies.end());
+
+        Sample sample;
+        sample.elapsed = total.elapsed();
+        sample.cycles = int(latencies.size());
+        sample.failures = failures;
+        sample.p50 = latencies[latencies.size() / 2];
+        sample.p99 = latencies[latencies.size() * 99 / 100];
+        sample.max = latencies.back();
+        sample.rss = residentSize();
+        sample.files = openFiles();
+        samples.push_back(sample);
+
+        qDebug("%3d/%d %8lld ms %7d cycles  p50 %8.1f us  p99 %8.1f us  rss %lld kB  files %d", window, windows,
+            sample.elapsed, sample.cycles, sample.p50, sample.p99, sample.rss, sample.files);
+    }
+
+    auto report = qgetenv("SOAK_REPORT");
+    if (!report.isEmpty())
+    {
+        QFile file(QString::fromLocal8Bit(report));
+        QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+        QTextStream out(&file);
+        out << "elapsed_ms,cycles,injected_failures,p50_us,p99_us,max_us,rss_kb,open_files\n";
+        foreach (const auto &s, samples)
+        {
+            out << s.elapsed << ',' << s.cycles << ',' << s.failures << ',' << s.p50 << ',' << s.p99 << ','
+                << s.max << ',' << s.rss << ',' << s.files << '\n';
+        }
+    }
+
+    // The first window is the warm up: the caches, the allocator arenas and so on.
+    std::vector<double> p50, p99, rss, files;
+    for (size_t i = 1; i < samples.size(); ++i)
+    {
+        p50.push_back(samples[i].p50);
+        p99.push_back(samples[i].p99);
+        rss.push_back(samples[i].rss);
+        files.push_back(samples[i].files);
+    }
+
+    // The latency is noisy, so it may grow by half over the run. The memory may grow by
+    // a megabyte, the files must not grow at all.
+    check("p50 latency", p50, p50.front() / 2 + 50);
+    check("p99 latency", p99, p99.front() / 2 + 200);
+    if (rss.front() >= 0)
+        check("resident size", rss, 1024);
+    if (files.front() >= 0)
+        check("open files", files, 0.5);
+}
+
+void SoakTest::check(const char *name, const std::vector<double> &values, double tolerance)
+{
+    // Both the trend and the actual growth, a single spike is not a leak.
+    auto growth = slope(values) * double(values.size() - 1);
+    auto actual = values.back() - values.front();
+
+    if (growth > tolerance && actual > tolerance)
+    {
+        QFAIL(qPrintable(QString("%1 grows: %2 -> %3, trend %4")
+                             .arg(name)
+                             .arg(values.front())
+                             .arg(values.back())
+                             .arg(growth)));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    // The soak may run for hours, far longer than the testlib watchdog allows.
+    if (qEnvironmentVariableIsEmpty("QTEST_FUNCTION_TIMEOUT"))
+    {
+        auto timeout = (qint64(envInt("SOAK_DURATION", 60)) + 600) * 1000;
+        qputenv("QTEST_FUNCTION_TIMEOUT", QByteArray::number(timeout));
+    }
+
+    QCoreApplication app(argc, argv);
+    SoakTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_soak.moc"